@@ -0,0 +1,260 @@
+// Times card geometry on the CPU for 10k cards on screen, no window or GL
+// needed. Immediate tessellates every card every frame the way raylib's
+// DrawRectangleRounded and DrawRectangleRoundedLinesEx do, a sinf and cosf
+// and a call per vertex into a stream. Rebuild builds every card's quads
+// into its slot with card_mesh_t. Kept is what a frame costs with
+// card_mesh_t once the cards are in: the state check of every card and the
+// cards that changed built again, one for a still frame where only the
+// current item's bar grew, three as the mouse moves between cards. Bytes are
+// what the frame uploads.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "../cardmesh.h"
+
+#define CARDS 10000
+#define SEGMENTS 8 // Per rounded corner, as raylib drew the cards
+#define RUNS 30
+
+static double now_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+//------------------------------------------------------------------------------
+// raylib style, vertices pushed one call at a time into a stream
+//------------------------------------------------------------------------------
+
+// What raylib's batch keeps of a vertex
+typedef struct stream_vertex
+{
+  float x, y, z;
+  float u, v;
+  mesh_color_t color;
+} stream_vertex_t;
+
+static stream_vertex_t *stream;
+static int stream_count;
+static int stream_capacity;
+static long streamed;
+
+__attribute__((noinline)) static void stream_vertex(float x, float y, mesh_color_t color)
+{
+  if (stream_count >= stream_capacity)
+    stream_count = 0; // raylib draws the batch and starts over
+  stream[stream_count++] = (stream_vertex_t){x, y, 0, 0, 0, color};
+  streamed++;
+}
+
+static void stream_quad(float left, float top, float right, float bottom, mesh_color_t color)
+{
+  stream_vertex(left, top, color);
+  stream_vertex(left, bottom, color);
+  stream_vertex(right, bottom, color);
+  stream_vertex(left, top, color);
+  stream_vertex(right, bottom, color);
+  stream_vertex(right, top, color);
+}
+
+static void stream_rounded(mesh_rect_t rect, float radius, float width, mesh_color_t color)
+{
+  float step = 90.0f / SEGMENTS;
+  float centers[4][2] = {{rect.x + radius, rect.y + radius},
+                         {rect.x + rect.width - radius, rect.y + radius},
+                         {rect.x + rect.width - radius, rect.y + rect.height - radius},
+                         {rect.x + radius, rect.y + rect.height - radius}};
+  float starts[4] = {180, 270, 0, 90};
+  float outer = radius + width;
+  for (int corner = 0; corner < 4; corner++)
+  {
+    float angle = starts[corner];
+    for (int i = 0; i < SEGMENTS; i++, angle += step)
+    {
+      float cx = centers[corner][0], cy = centers[corner][1];
+      float a0 = angle * (float)M_PI / 180, a1 = (angle + step) * (float)M_PI / 180;
+      if (width <= 0)
+      {
+        stream_vertex(cx, cy, color);
+        stream_vertex(cx + cosf(a1) * radius, cy + sinf(a1) * radius, color);
+        stream_vertex(cx + cosf(a0) * radius, cy + sinf(a0) * radius, color);
+        continue;
+      }
+      stream_vertex(cx + cosf(a0) * radius, cy + sinf(a0) * radius, color);
+      stream_vertex(cx + cosf(a1) * outer, cy + sinf(a1) * outer, color);
+      stream_vertex(cx + cosf(a0) * outer, cy + sinf(a0) * outer, color);
+      stream_vertex(cx + cosf(a0) * radius, cy + sinf(a0) * radius, color);
+      stream_vertex(cx + cosf(a1) * radius, cy + sinf(a1) * radius, color);
+      stream_vertex(cx + cosf(a1) * outer, cy + sinf(a1) * outer, color);
+    }
+  }
+
+  float left = rect.x + radius, right = rect.x + rect.width - radius;
+  float top = rect.y + radius, bottom = rect.y + rect.height - radius;
+  if (width <= 0)
+  {
+    stream_quad(left, rect.y, right, rect.y + rect.height, color);
+    stream_quad(rect.x, top, left, bottom, color);
+    stream_quad(right, top, rect.x + rect.width, bottom, color);
+    return;
+  }
+  stream_quad(left, rect.y - width, right, rect.y, color);
+  stream_quad(rect.x + rect.width, top, rect.x + rect.width + width, bottom, color);
+  stream_quad(left, rect.y + rect.height, right, rect.y + rect.height + width, color);
+  stream_quad(rect.x - width, top, rect.x, bottom, color);
+}
+
+static float radius_of(mesh_rect_t rect, float roundness)
+{
+  return (rect.width > rect.height ? rect.height : rect.width) * roundness / 2;
+}
+
+static void stream_card(const mesh_card_t *card)
+{
+  mesh_rect_t r = card->rect;
+  stream_quad(r.x, r.y, r.x + r.width, r.y + r.height, card->fill);
+  if (card->shade.a)
+    stream_quad(r.x, r.y, r.x + r.width, r.y + r.height, card->shade);
+  stream_rounded(r, radius_of(r, card->roundness), card->line_width, card->line);
+  mesh_rect_t progress = r;
+  progress.width = card->progress;
+  if (progress.width > 0)
+    stream_rounded(progress, radius_of(progress, card->roundness), 0, card->progress_color);
+  if (card->marker.width > 0)
+  {
+    stream_rounded(card->marker, radius_of(card->marker, card->roundness), card->marker_line_width, card->marker_line);
+    stream_rounded(card->marker, radius_of(card->marker, card->roundness), 0, card->marker_fill);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Cards
+//------------------------------------------------------------------------------
+
+static mesh_card_t cards[CARDS];
+static unsigned int states[CARDS];
+
+// A day's list as draw_schedule builds it, the first third done
+static void make_cards(void)
+{
+  for (int i = 0; i < CARDS; i++)
+  {
+    mesh_card_t *card = &cards[i];
+    memset(card, 0, sizeof(*card));
+    card->rect = (mesh_rect_t){14, 64 + i * 114.0f, 752, 100};
+    card->roundness = 0.1f;
+    card->fill = i % 3 == 0 ? (mesh_color_t){235, 240, 255, 255} : (mesh_color_t){245, 235, 255, 255};
+    card->line_width = 3;
+    card->line = (mesh_color_t){80, 80, 80, 255};
+    card->progress = i < CARDS / 3 ? 752 : 0;
+    card->progress_color = (mesh_color_t){80, 80, 80, 40};
+    states[i] = 1 | (i < CARDS / 3) << 2;
+  }
+  mesh_card_t *current = &cards[CARDS / 3];
+  current->line = (mesh_color_t){200, 122, 255, 255};
+  current->progress = 300;
+  current->marker = (mesh_rect_t){650, current->rect.y + 60, 100, 20};
+  current->marker_line_width = 3;
+  current->marker_line = (mesh_color_t){200, 122, 255, 200};
+  current->marker_fill = (mesh_color_t){200, 122, 255, 100};
+  states[CARDS / 3] |= 2;
+}
+
+static double immediate(card_mesh_t *mesh, long *bytes)
+{
+  streamed = 0;
+  for (int i = 0; i < CARDS; i++)
+  {
+    stream_card(&cards[i]);
+  }
+  *bytes = streamed * sizeof(stream_vertex_t);
+  return stream[stream_count / 2].x;
+}
+
+static double rebuild(card_mesh_t *mesh, long *bytes)
+{
+  card_mesh_clear(mesh);
+  for (int i = 0; i < CARDS; i++)
+  {
+    card_mesh_set(mesh, i, states[i], &cards[i]);
+  }
+  int first, count;
+  *bytes = 0;
+  while (card_mesh_take_dirty(mesh, &first, &count))
+    *bytes += (long)count * sizeof(mesh_vertex_t);
+  return mesh->vertices[CARDS / 2 * CARD_MESH_VERTICES].x;
+}
+
+// Cards touched each frame, changed before the frame is built
+static int touched;
+static int frame;
+
+static double kept(card_mesh_t *mesh, long *bytes)
+{
+  frame++;
+  int current = CARDS / 3;
+  cards[current].progress = 300 + frame % 400;
+  states[current] = (states[current] & 0xfff) | (unsigned int)cards[current].progress << 12;
+  if (touched > 1)
+  {
+    // Hover moves from one card to the next
+    int from = CARDS / 2 + frame % 1000;
+    cards[from].shade = (mesh_color_t){0};
+    states[from] &= ~8u;
+    cards[from + 1].shade = (mesh_color_t){0, 0, 0, 12};
+    states[from + 1] |= 8u;
+  }
+
+  for (int i = 0; i < CARDS; i++)
+  {
+    if (!card_mesh_holds(mesh, i, states[i]))
+      card_mesh_set(mesh, i, states[i], &cards[i]);
+  }
+  int first, count;
+  *bytes = 0;
+  while (card_mesh_take_dirty(mesh, &first, &count))
+    *bytes += (long)count * sizeof(mesh_vertex_t);
+  return mesh->vertices[current * CARD_MESH_VERTICES].x;
+}
+
+static void run(const char *name, double (*build)(card_mesh_t *, long *), card_mesh_t *mesh)
+{
+  long bytes = 0;
+  double checksum = build(mesh, &bytes); // Warm up, and fills the mesh for kept
+  double best = 1e9, total = 0;
+  for (int i = 0; i < RUNS; i++)
+  {
+    double start = now_ms();
+    checksum += build(mesh, &bytes);
+    double elapsed = now_ms() - start;
+    total += elapsed;
+    if (elapsed < best)
+      best = elapsed;
+  }
+  printf("%-18s %8.3f ms best %8.3f ms mean %9.1f KB uploaded (checksum %g)\n",
+         name, best, total / RUNS, bytes / 1024.0, checksum);
+}
+
+int main(void)
+{
+  card_mesh_t *mesh = card_mesh_create(CARDS);
+  stream_capacity = 8192 * 4; // raylib's default batch
+  stream = malloc(sizeof(stream_vertex_t) * stream_capacity);
+  make_cards();
+
+  printf("%d cards, %d kept vertices each, best and mean of %d frames\n", CARDS, CARD_MESH_VERTICES, RUNS);
+  run("immediate", immediate, mesh);
+  run("rebuild", rebuild, mesh);
+  rebuild(mesh, &(long){0});
+  touched = 1;
+  run("kept, still", kept, mesh);
+  touched = 3;
+  run("kept, hover", kept, mesh);
+
+  card_mesh_destroy(mesh);
+  free(stream);
+  return 0;
+}
@@ -0,0 +1,102 @@
+// Lays out the schedule list the way draw_schedule does, every card with its
+// nested contexts, and counts heap calls made while doing so. Linked with
+// -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc, see the bench-alloc target.
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../fbox.h"
+
+#define ITEMS 1000
+#define FRAMES 200
+
+static long heap_calls = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+  heap_calls++;
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+  heap_calls++;
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+  heap_calls++;
+  return __real_realloc(ptr, size);
+}
+
+static float layout_frame(float *content_height)
+{
+  float checksum = 0;
+  fbox_context_t items_fbox = fbox_layout_create((fbox_rect_t){0, 50, 800, 550}, fbox_DIRECTION_COLUMN, 1.0f, 1.0f);
+  items_fbox.content_max = content_height;
+  fbox_set_gap(&items_fbox, 14);
+  fbox_set_padding(&items_fbox, 14);
+  fbox_set_expected_items(&items_fbox, ITEMS);
+  fbox_set_size_mode(&items_fbox, fbox_SIZE_STRETCH);
+
+  for (int i = 0; i < ITEMS; i++)
+  {
+    fbox_rect_t itemRect = fbox_layout_next(&items_fbox, (fbox_vec2_t){0, 100});
+
+    fbox_context_t content = fbox_layout_nested(&items_fbox, itemRect);
+    fbox_set_direction(&content, fbox_DIRECTION_ROW);
+    fbox_set_main_align(&content, fbox_ALIGN_SPACE_BETWEEN);
+    fbox_set_padding(&content, 10);
+    fbox_set_expected_items(&content, 2);
+    fbox_set_size_mode(&content, fbox_SIZE_STRETCH);
+    fbox_set_flex_weights(&content, (float[]){0.7f, 0.3f});
+
+    fbox_rect_t info_rect = fbox_layout_next(&content, (fbox_vec2_t){0, itemRect.height});
+    fbox_context_t info = fbox_layout_nested(&content, info_rect);
+    fbox_set_direction(&info, fbox_DIRECTION_COLUMN);
+    fbox_set_gap(&info, 5);
+    fbox_set_expected_items(&info, 2);
+    checksum += fbox_layout_next(&info, (fbox_vec2_t){0, 20}).y;
+    checksum += fbox_layout_next(&info, (fbox_vec2_t){0, 20}).y;
+    fbox_destroy(&info);
+
+    fbox_rect_t progress_rect = fbox_layout_next(&content, (fbox_vec2_t){0, itemRect.height});
+    fbox_context_t progress = fbox_layout_nested(&content, progress_rect);
+    fbox_set_direction(&progress, fbox_DIRECTION_COLUMN);
+    fbox_set_cross_align(&progress, fbox_ALIGN_END);
+    fbox_set_expected_items(&progress, 2);
+    checksum += fbox_layout_next(&progress, (fbox_vec2_t){30, 20}).x;
+    checksum += fbox_layout_next(&progress, (fbox_vec2_t){60, 20}).x;
+    fbox_destroy(&progress);
+
+    fbox_destroy(&content);
+  }
+
+  fbox_destroy(&items_fbox);
+  return checksum;
+}
+
+int main(void)
+{
+  float content_height = 0;
+  float checksum = layout_frame(&content_height); // Warm up
+
+  long before = heap_calls;
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int frame = 0; frame < FRAMES; frame++)
+  {
+    checksum += layout_frame(&content_height);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  long calls = heap_calls - before;
+
+  double ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+  printf("%d frames of %d cards: %.3f ms/frame, %ld heap calls (checksum %g)\n",
+         FRAMES, ITEMS, ms / FRAMES, calls, checksum);
+  return calls == 0 ? 0 : 1;
+}
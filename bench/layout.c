@@ -0,0 +1,245 @@
+// Times the fbox core on its own, no window or GL needed. Wide is a list of
+// cards nested like draw_schedule, laid out immediately and in two passes,
+// deep is a chain of containers each nested in the last. Batch lays out the
+// card list for a week and for 100k cards with one fbox_layout_batch call,
+// against a call to fbox_layout_next per card. Before timing anything, the
+// three ways of placing a group are checked to give the same rects.
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../fbox.h"
+
+#define ITEMS 10000
+#define RUNS 50
+#define BATCH_ITEMS 100000
+#define BATCH_RUNS 30
+#define WEEK_CARDS (7 * 24)
+
+static double now_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// Inner layout of one card, as draw_schedule builds it
+static float layout_card(fbox_context_t *list, fbox_rect_t card)
+{
+  float checksum = 0;
+  fbox_context_t content = fbox_layout_nested(list, card);
+  fbox_set_direction(&content, fbox_DIRECTION_ROW);
+  fbox_set_main_align(&content, fbox_ALIGN_SPACE_BETWEEN);
+  fbox_set_padding(&content, 10);
+  fbox_set_expected_items(&content, 2);
+  fbox_set_size_mode(&content, fbox_SIZE_STRETCH);
+  fbox_set_flex_weights(&content, (float[]){0.7f, 0.3f});
+
+  fbox_rect_t info_rect = fbox_layout_next(&content, (fbox_vec2_t){0, card.height});
+  fbox_context_t info = fbox_layout_nested(&content, info_rect);
+  fbox_set_direction(&info, fbox_DIRECTION_COLUMN);
+  fbox_set_gap(&info, 5);
+  fbox_set_expected_items(&info, 2);
+  checksum += fbox_layout_next(&info, (fbox_vec2_t){0, 20}).y;
+  checksum += fbox_layout_next(&info, (fbox_vec2_t){0, 20}).y;
+
+  fbox_rect_t progress_rect = fbox_layout_next(&content, (fbox_vec2_t){0, card.height});
+  fbox_context_t progress = fbox_layout_nested(&content, progress_rect);
+  fbox_set_direction(&progress, fbox_DIRECTION_COLUMN);
+  fbox_set_cross_align(&progress, fbox_ALIGN_END);
+  fbox_set_expected_items(&progress, 2);
+  checksum += fbox_layout_next(&progress, (fbox_vec2_t){30, 20}).x;
+  checksum += fbox_layout_next(&progress, (fbox_vec2_t){60, 20}).x;
+  return checksum;
+}
+
+static fbox_context_t make_list(void)
+{
+  fbox_context_t list = fbox_layout_create((fbox_rect_t){0, 50, 800, 550}, fbox_DIRECTION_COLUMN, 1.0f, 1.0f);
+  fbox_set_gap(&list, 14);
+  fbox_set_padding(&list, 14);
+  fbox_set_expected_items(&list, ITEMS);
+  fbox_set_size_mode(&list, fbox_SIZE_STRETCH);
+  return list;
+}
+
+static float wide_immediate(fbox_rect_t *rects)
+{
+  float checksum = 0;
+  fbox_context_t list = make_list();
+  for (int i = 0; i < ITEMS; i++)
+  {
+    checksum += layout_card(&list, fbox_layout_next(&list, (fbox_vec2_t){0, 100}));
+  }
+  return checksum;
+}
+
+static float wide_two_pass(fbox_rect_t *rects)
+{
+  float checksum = 0;
+  fbox_context_t list = make_list();
+  fbox_set_storage(&list, rects, ITEMS);
+  for (int i = 0; i < ITEMS; i++)
+  {
+    fbox_layout_measure(&list, (fbox_vec2_t){0, 100});
+  }
+  fbox_arrange(&list);
+  for (int i = 0; i < ITEMS; i++)
+  {
+    checksum += layout_card(&list, rects[i]);
+  }
+  return checksum;
+}
+
+static float deep(fbox_rect_t *rects)
+{
+  float checksum = 0;
+  fbox_context_t ctx = fbox_layout_create((fbox_rect_t){0, 0, 800, 600}, fbox_DIRECTION_ROW, 1.0f, 1.0f);
+  for (int i = 0; i < ITEMS; i++)
+  {
+    // A label, then the container holding the next level, alternating axes
+    fbox_set_direction(&ctx, i % 2 ? fbox_DIRECTION_COLUMN : fbox_DIRECTION_ROW);
+    fbox_set_expected_items(&ctx, 2);
+    fbox_set_size_mode(&ctx, fbox_SIZE_STRETCH);
+    checksum += fbox_layout_next(&ctx, (fbox_vec2_t){10, 10}).x;
+    fbox_rect_t inner = fbox_layout_next(&ctx, (fbox_vec2_t){10, 10});
+    ctx = fbox_layout_nested(&ctx, inner);
+  }
+  return checksum;
+}
+
+static fbox_context_t make_column(void)
+{
+  fbox_context_t list = fbox_layout_create((fbox_rect_t){0, 50, 800, 550}, fbox_DIRECTION_COLUMN, 1.0f, 1.0f);
+  fbox_set_gap(&list, 14);
+  fbox_set_padding(&list, 14);
+  fbox_set_size_mode(&list, fbox_SIZE_STRETCH);
+  return list;
+}
+
+static void run_batch(const char *name, int count, fbox_vec2_t *sizes, fbox_rect_t *rects)
+{
+  double best_next = 1e9, best_batch = 1e9;
+  float checksum = 0;
+  for (int i = 0; i < count; i++)
+  {
+    sizes[i] = (fbox_vec2_t){0, 100 + (i % 3) * 20};
+  }
+
+  for (int run = 0; run < BATCH_RUNS; run++)
+  {
+    fbox_context_t list = make_column();
+    fbox_set_expected_items(&list, count);
+    double start = now_ms();
+    for (int i = 0; i < count; i++)
+    {
+      rects[i] = fbox_layout_next(&list, sizes[i]);
+    }
+    double elapsed = now_ms() - start;
+    checksum += rects[count - 1].y;
+    if (elapsed < best_next)
+      best_next = elapsed;
+
+    list = make_column();
+    start = now_ms();
+    fbox_layout_batch(&list, sizes, rects, count);
+    elapsed = now_ms() - start;
+    checksum += rects[count - 1].y;
+    if (elapsed < best_batch)
+      best_batch = elapsed;
+  }
+  printf("%-14s %8.1f us next %8.1f us batch %5.2fx (checksum %g)\n",
+         name, best_next * 1e3, best_batch * 1e3, best_next / best_batch, checksum);
+}
+
+// Start aligned rows and columns with different padding on each axis, laid
+// out with fbox_layout_next, measure and arrange, and fbox_layout_batch.
+// Returns false and prints the first rect that differs.
+static bool check_paths(void)
+{
+  fbox_vec2_t sizes[] = {{40, 20}, {60, 30}, {50, 25}};
+  int count = sizeof(sizes) / sizeof(sizes[0]);
+  fbox_rect_t next[3], arranged[3], batch[3];
+
+  for (int d = 0; d < 2; d++)
+  {
+    fbox_direction_t direction = d ? fbox_DIRECTION_COLUMN : fbox_DIRECTION_ROW;
+    fbox_context_t ctx = fbox_layout_create((fbox_rect_t){10, 20, 400, 300}, direction, 1.0f, 1.0f);
+    fbox_set_padding_x(&ctx, 7);
+    fbox_set_padding_y(&ctx, 19);
+    fbox_set_gap(&ctx, 5);
+    fbox_set_expected_items(&ctx, count);
+    fbox_context_t two_pass = ctx;
+    fbox_context_t batched = ctx;
+
+    for (int i = 0; i < count; i++)
+    {
+      next[i] = fbox_layout_next(&ctx, sizes[i]);
+    }
+    fbox_set_storage(&two_pass, arranged, count);
+    for (int i = 0; i < count; i++)
+    {
+      fbox_layout_measure(&two_pass, sizes[i]);
+    }
+    fbox_arrange(&two_pass);
+    fbox_layout_batch(&batched, sizes, batch, count);
+
+    for (int i = 0; i < count; i++)
+    {
+      if (next[i].x != arranged[i].x || next[i].y != arranged[i].y ||
+          next[i].x != batch[i].x || next[i].y != batch[i].y)
+      {
+        printf("%s item %d: next %g,%g arrange %g,%g batch %g,%g\n", d ? "column" : "row", i,
+               next[i].x, next[i].y, arranged[i].x, arranged[i].y, batch[i].x, batch[i].y);
+        return false;
+      }
+    }
+    float main_next = d ? fbox_get_content_height(&ctx) : fbox_get_content_width(&ctx);
+    float main_arranged = d ? fbox_get_content_height(&two_pass) : fbox_get_content_width(&two_pass);
+    if (main_next != main_arranged)
+    {
+      printf("%s content: next %g arrange %g\n", d ? "column" : "row", main_next, main_arranged);
+      return false;
+    }
+  }
+  return true;
+}
+
+static void run(const char *name, float (*layout)(fbox_rect_t *), fbox_rect_t *rects)
+{
+  float checksum = layout(rects); // Warm up
+  double best = 1e9, total = 0;
+  for (int i = 0; i < RUNS; i++)
+  {
+    double start = now_ms();
+    checksum += layout(rects);
+    double elapsed = now_ms() - start;
+    total += elapsed;
+    if (elapsed < best)
+      best = elapsed;
+  }
+  printf("%-14s %8.3f ms best %8.3f ms mean %7.1f ns/item (checksum %g)\n",
+         name, best, total / RUNS, best * 1e6 / ITEMS, checksum);
+}
+
+int main(void)
+{
+  if (!check_paths())
+    return 1;
+
+  fbox_rect_t *rects = malloc(sizeof(fbox_rect_t) * ITEMS);
+  printf("%d items, best and mean of %d runs\n", ITEMS, RUNS);
+  run("wide", wide_immediate, rects);
+  run("wide two-pass", wide_two_pass, rects);
+  run("deep", deep, rects);
+
+  fbox_vec2_t *sizes = malloc(sizeof(fbox_vec2_t) * BATCH_ITEMS);
+  fbox_rect_t *batch = malloc(sizeof(fbox_rect_t) * BATCH_ITEMS);
+  printf("\nCard list in one call, best of %d runs\n", BATCH_RUNS);
+  run_batch("week", WEEK_CARDS, sizes, batch);
+  run_batch("100k", BATCH_ITEMS, sizes, batch);
+  free(sizes);
+  free(batch);
+  free(rects);
+  return 0;
+}
@@ -0,0 +1,376 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "calendar.h"
+
+#define CALENDAR_INITIAL_CAPACITY 16
+
+static const char *weekdays[] = {"sunday", "monday", "tuesday", "wednesday", "thursday", "friday", "saturday"};
+
+// Binary search over the sorted index. Returns the position of date, or the
+// position it should be inserted at with found set to false.
+static int calendar_find(calendar_t *calendar, int date, bool *found)
+{
+  int lo = 0;
+  int hi = calendar->count;
+  while (lo < hi)
+  {
+    int mid = lo + (hi - lo) / 2;
+    if (calendar->days[mid].date < date)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  *found = lo < calendar->count && calendar->days[lo].date == date;
+  return lo;
+}
+
+static calendar_day_t *calendar_insert(calendar_t *calendar, int index, int date)
+{
+  if (calendar->count == calendar->capacity)
+  {
+    calendar->capacity *= 2;
+    calendar->days = (calendar_day_t *)realloc(calendar->days, sizeof(calendar_day_t) * calendar->capacity);
+  }
+
+  memmove(&calendar->days[index + 1],
+          &calendar->days[index],
+          sizeof(calendar_day_t) * (calendar->count - index));
+  calendar->count++;
+
+  calendar_day_t *day = &calendar->days[index];
+  day->date = date;
+  day->loaded = false;
+  day->error = PARSE_SUCCESS;
+  day->schedule = NULL;
+  day->path = NULL;
+  day->stamp = (calendar_stamp_t){0};
+  return day;
+}
+
+static calendar_stamp_t file_stamp(const char *path)
+{
+  struct stat st;
+  if (stat(path, &st) != 0)
+    return (calendar_stamp_t){0};
+
+  calendar_stamp_t stamp = {(long long)st.st_mtime * 1000000000LL, (long long)st.st_size, (unsigned long long)st.st_ino};
+#if defined(__APPLE__)
+  stamp.mtime_ns += st.st_mtimespec.tv_nsec;
+#elif !defined(_WIN32)
+  stamp.mtime_ns += st.st_mtim.tv_nsec;
+#endif
+  if (stamp.mtime_ns == 0)
+    stamp.mtime_ns = 1; // A file from 1970 still exists
+  return stamp;
+}
+
+static bool same_stamp(calendar_stamp_t a, calendar_stamp_t b)
+{
+  return a.mtime_ns == b.mtime_ns && a.size == b.size && a.inode == b.inode;
+}
+
+static void calendar_trim(schedule_t *schedule)
+{
+  // Trim the slab, days are read far more often than they grow
+  if (schedule->count + 1 < schedule->capacity)
+  {
+    resize_schedule(schedule, schedule->count + 1);
+  }
+}
+
+// folder + "/" + name + ".schedule", NULL when out of memory
+static char *calendar_path(calendar_t *calendar, const char *name)
+{
+  char *filepath = malloc(strlen(calendar->folder) + 1 + strlen(name) + 9 + 1);
+  if (filepath)
+    sprintf(filepath, "%s/%s.schedule", calendar->folder, name);
+  return filepath;
+}
+
+static void calendar_dated_name(int date, char name[16])
+{
+  int year, month, mday;
+  date_to_ymd(date, &year, &month, &mday);
+  snprintf(name, 16, "%04d-%02d-%02d", year, month, mday);
+}
+
+// File the day's schedule comes from as things stand on disk: the dated file
+// if there is one, the weekday file if not. NULL when neither exists or out of
+// memory, with error saying which.
+static char *calendar_find_file(calendar_t *calendar, int date, calendar_stamp_t *stamp, parse_error_t *error)
+{
+  char dated[16];
+  calendar_dated_name(date, dated);
+
+  const char *names[] = {dated, weekdays[date_weekday(date)]};
+  for (int i = 0; i < 2; i++)
+  {
+    char *filepath = calendar_path(calendar, names[i]);
+    if (!filepath)
+    {
+      *error = PARSE_ERROR_MEMORY;
+      return NULL;
+    }
+
+    *stamp = file_stamp(filepath);
+    if (stamp->mtime_ns != 0)
+      return filepath;
+    free(filepath);
+  }
+
+  *error = PARSE_ERROR_FILE_NOT_FOUND;
+  return NULL;
+}
+
+static void calendar_load_day(calendar_t *calendar, calendar_day_t *day)
+{
+  // Keep the path even if parsing fails, so fixing the file reloads it
+  day->schedule = NULL;
+  day->path = calendar_find_file(calendar, day->date, &day->stamp, &day->error);
+  if (day->path)
+  {
+    day->schedule = parse_schedule_file_on(day->path, day->date, &day->error);
+  }
+
+  if (day->schedule)
+  {
+    calendar_trim(day->schedule);
+  }
+
+  day->loaded = true;
+}
+
+calendar_t *calendar_create(const char *folder)
+{
+  calendar_t *calendar = (calendar_t *)malloc(sizeof(calendar_t));
+  if (!calendar)
+    return NULL;
+
+  calendar->folder = strdup(folder);
+  calendar->days = (calendar_day_t *)malloc(sizeof(calendar_day_t) * CALENDAR_INITIAL_CAPACITY);
+  calendar->count = 0;
+  calendar->capacity = CALENDAR_INITIAL_CAPACITY;
+  calendar->prefetch.active = false;
+  atomic_init(&calendar->prefetch.done, false);
+  return calendar;
+}
+
+void calendar_destroy(calendar_t *calendar)
+{
+  if (calendar == NULL)
+    return;
+
+  if (calendar->prefetch.active)
+  {
+    pthread_join(calendar->prefetch.thread, NULL);
+    if (calendar->prefetch.day.schedule != NULL)
+      destroy_schedule(calendar->prefetch.day.schedule);
+    free(calendar->prefetch.day.path);
+  }
+
+  for (int i = 0; i < calendar->count; i++)
+  {
+    if (calendar->days[i].schedule != NULL)
+    {
+      destroy_schedule(calendar->days[i].schedule);
+    }
+    free(calendar->days[i].path);
+  }
+  free(calendar->days);
+  free(calendar->folder);
+  free(calendar);
+}
+
+schedule_t *calendar_get_day(calendar_t *calendar, int date, parse_error_t *error)
+{
+  bool found;
+  int index = calendar_find(calendar, date, &found);
+  calendar_day_t *day = found ? &calendar->days[index] : calendar_insert(calendar, index, date);
+
+  if (!day->loaded)
+  {
+    calendar_load_day(calendar, day);
+  }
+
+  if (error)
+    *error = day->error;
+  return day->schedule;
+}
+
+int calendar_get_range(calendar_t *calendar, int first, int count, schedule_t **out)
+{
+  int found = 0;
+  for (int i = 0; i < count; i++)
+  {
+    out[i] = calendar_get_day(calendar, first + i, NULL);
+    if (out[i] != NULL)
+      found++;
+  }
+  return found;
+}
+
+diff_t *calendar_reload_day(calendar_t *calendar, int date, parse_error_t *error)
+{
+  bool found;
+  int index = calendar_find(calendar, date, &found);
+  if (!found || !calendar->days[index].loaded)
+    return NULL;
+
+  // Look the file up again rather than watching the one read last: a dated
+  // file may have turned up over the weekday one, or gone and left it showing
+  // through, or a day that had no file may have one now. With neither there
+  // the day keeps what it has, the file is probably being saved.
+  calendar_day_t *day = &calendar->days[index];
+  parse_error_t parse_error;
+  calendar_stamp_t stamp;
+  char *path = calendar_find_file(calendar, date, &stamp, &parse_error);
+  if (!path)
+    return NULL;
+  if (day->path && strcmp(path, day->path) == 0 && same_stamp(stamp, day->stamp))
+  {
+    free(path);
+    return NULL;
+  }
+
+  schedule_t *fresh = parse_schedule_file_on(path, date, &parse_error);
+  if (error)
+    *error = parse_error;
+  if (!fresh)
+  {
+    free(path);
+    return NULL; // Probably caught mid-save, try again on the next change
+  }
+
+  free(day->path);
+  day->path = path;
+  day->stamp = stamp;
+  day->error = PARSE_SUCCESS;
+  calendar_trim(fresh);
+
+  if (day->schedule == NULL)
+  {
+    // There was no file, or it was broken when first read
+    day->schedule = fresh;
+    return diff_schedules(&(schedule_t){0}, fresh);
+  }
+
+  diff_t *diff = diff_schedules(day->schedule, fresh);
+
+  // Swap the items in so everyone holding the schedule sees the new ones
+  schedule_t old = *day->schedule;
+  day->schedule->items = fresh->items;
+  day->schedule->count = fresh->count;
+  day->schedule->capacity = fresh->capacity;
+  day->schedule->version++;
+  fresh->items = old.items;
+  destroy_schedule(fresh);
+  return diff;
+}
+
+bool calendar_save_day(calendar_t *calendar, int date)
+{
+  bool found;
+  int index = calendar_find(calendar, date, &found);
+  if (!found || calendar->days[index].schedule == NULL)
+    return false;
+
+  char dated[16];
+  calendar_dated_name(date, dated);
+  char *path = calendar_path(calendar, dated);
+  if (!path)
+    return false;
+
+  calendar_day_t *day = &calendar->days[index];
+  if (!write_schedule_file(path, day->schedule))
+  {
+    free(path);
+    return false;
+  }
+
+  // A reload finds this file with this stamp and leaves the day alone
+  free(day->path);
+  day->path = path;
+  day->stamp = file_stamp(path);
+  return true;
+}
+
+static void *calendar_prefetch_run(void *arg)
+{
+  calendar_prefetch_t *prefetch = (calendar_prefetch_t *)arg;
+  calendar_load_day(prefetch->calendar, &prefetch->day);
+  atomic_store(&prefetch->done, true);
+  return NULL;
+}
+
+bool calendar_prefetch_day(calendar_t *calendar, int date)
+{
+  calendar_prefetch_t *prefetch = &calendar->prefetch;
+  if (prefetch->active)
+    return false;
+
+  bool found;
+  int index = calendar_find(calendar, date, &found);
+  if (found && calendar->days[index].loaded)
+    return false;
+
+  prefetch->calendar = calendar;
+  prefetch->day = (calendar_day_t){.date = date};
+  atomic_store(&prefetch->done, false);
+  if (pthread_create(&prefetch->thread, NULL, calendar_prefetch_run, prefetch) != 0)
+    return false;
+
+  prefetch->active = true;
+  return true;
+}
+
+void calendar_poll(calendar_t *calendar)
+{
+  calendar_prefetch_t *prefetch = &calendar->prefetch;
+  if (!prefetch->active || !atomic_load(&prefetch->done))
+    return;
+
+  pthread_join(prefetch->thread, NULL);
+  prefetch->active = false;
+
+  bool found;
+  int index = calendar_find(calendar, prefetch->day.date, &found);
+  if (found && calendar->days[index].loaded)
+  {
+    // Read synchronously in the meantime, keep that one
+    if (prefetch->day.schedule != NULL)
+      destroy_schedule(prefetch->day.schedule);
+    free(prefetch->day.path);
+    return;
+  }
+
+  calendar_day_t *day = found ? &calendar->days[index] : calendar_insert(calendar, index, prefetch->day.date);
+  *day = prefetch->day;
+}
+
+bool calendar_day_loaded(calendar_t *calendar, int date)
+{
+  bool found;
+  int index = calendar_find(calendar, date, &found);
+  return found && calendar->days[index].loaded;
+}
+
+void calendar_unload_day(calendar_t *calendar, int date)
+{
+  bool found;
+  int index = calendar_find(calendar, date, &found);
+  if (!found)
+    return;
+
+  if (calendar->days[index].schedule != NULL)
+  {
+    destroy_schedule(calendar->days[index].schedule);
+  }
+  free(calendar->days[index].path);
+
+  memmove(&calendar->days[index],
+          &calendar->days[index + 1],
+          sizeof(calendar_day_t) * (calendar->count - index - 1));
+  calendar->count--;
+}
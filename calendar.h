@@ -0,0 +1,94 @@
+#ifndef CALENDAR_H
+#define CALENDAR_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "data.h"
+#include "parser.h"
+#include "diff.h"
+
+// What a schedule file looked like when it was read. Modification times alone
+// miss a second save within the same second on filesystems that keep whole
+// seconds, so the size and inode (a new one for editors that save by
+// renaming) are compared too.
+typedef struct calendar_stamp
+{
+  long long mtime_ns; // 0 when there is no file
+  long long size;
+  unsigned long long inode;
+} calendar_stamp_t;
+
+// One loaded (or looked up) day. The day's items live in the schedule's own
+// contiguous items array, trimmed to size once the file is parsed.
+typedef struct calendar_day
+{
+  int date;             // Days since 1970-01-01, see date_from_ymd
+  bool loaded;          // Lookup already attempted, don't touch the disk again
+  parse_error_t error;  // Outcome of the lookup
+  schedule_t *schedule; // NULL when there is no (valid) file for the date
+  char *path;           // File the schedule was read from
+  calendar_stamp_t stamp; // Of path when it was read
+} calendar_day_t;
+
+// A day being read on a background thread
+typedef struct calendar_prefetch
+{
+  pthread_t thread;
+  struct calendar *calendar;
+  calendar_day_t day; // Filled in by the thread
+  atomic_bool done;   // Set by the thread once day is complete
+  bool active;        // Thread started and not yet joined
+} calendar_prefetch_t;
+
+// Multi-day container. Days are kept in an index sorted by date and only read
+// from disk the first time they are asked for.
+typedef struct calendar
+{
+  char *folder;         // Folder holding the .schedule files
+  calendar_day_t *days; // Index of days, sorted by date
+  int count;
+  int capacity;
+  calendar_prefetch_t prefetch;
+} calendar_t;
+
+calendar_t *calendar_create(const char *folder);
+void calendar_destroy(calendar_t *calendar);
+
+// Returns the schedule for a date, loading it on first access. Looks for
+// "YYYY-MM-DD.schedule" first and falls back to the weekday file
+// ("monday.schedule", ...). Returns NULL and sets error if neither parses.
+schedule_t *calendar_get_day(calendar_t *calendar, int date, parse_error_t *error);
+
+// Fills out[0..count) with the schedules of count consecutive days starting at
+// first (NULL for days without one). Returns how many days had a schedule.
+int calendar_get_range(calendar_t *calendar, int first, int count, schedule_t **out);
+
+// Re-reads a loaded day if the file it comes from changed on disk, or another
+// file now takes precedence (a dated file over the weekday one), or a day that
+// had none has one now. The new items replace the old ones inside the same
+// schedule_t, and the returned diff (to be freed with diff_destroy) says what
+// changed. Returns NULL when nothing was reloaded.
+diff_t *calendar_reload_day(calendar_t *calendar, int date, parse_error_t *error);
+
+// Writes a loaded day's items to its dated file, "YYYY-MM-DD.schedule", so
+// edits stay with that day even when it was read from the weekday file. The
+// day then comes from the dated file, and the write itself isn't reloaded.
+// Returns false when the day has no schedule or the file couldn't be written.
+bool calendar_save_day(calendar_t *calendar, int date);
+
+// Starts reading a day on a background thread so a later calendar_get_day
+// doesn't touch the disk. Only one prefetch runs at a time; returns false if
+// the day is already loaded or another prefetch is still running.
+bool calendar_prefetch_day(calendar_t *calendar, int date);
+
+// Moves a finished prefetch into the index. The index is only ever changed
+// from the thread calling this, so call it from the main loop.
+void calendar_poll(calendar_t *calendar);
+
+// Whether date was looked up already, so calendar_get_day won't read it now
+bool calendar_day_loaded(calendar_t *calendar, int date);
+
+// Drops a loaded day so the next access reads it from disk again
+void calendar_unload_day(calendar_t *calendar, int date);
+
+#endif // CALENDAR_H
@@ -0,0 +1,190 @@
+#include <stdlib.h>
+#include <stddef.h>
+#include "raylib.h"
+#include "rlgl.h"
+#include "raymath.h"
+#include "cardbatch.h"
+
+// Rounded rect from its signed distance, outline and fill covered by how much
+// of the pixel lies inside each edge. The edges come out antialiased without
+// multisampling, and the same at any size.
+static const char *CARD_BATCH_VERTEX_SHADER =
+    "#version 330\n"
+    "in vec3 vertexPosition;\n"
+    "in vec4 vertexColor;\n"
+    "in vec2 shapePoint;\n"
+    "in vec4 shapeSize;\n"
+    "in vec4 shapeLine;\n"
+    "uniform mat4 mvp;\n"
+    "out vec2 point;\n"
+    "out vec4 size;\n"
+    "out vec4 fill;\n"
+    "out vec4 line;\n"
+    "void main()\n"
+    "{\n"
+    "  point = shapePoint;\n"
+    "  size = shapeSize;\n"
+    "  fill = vertexColor;\n"
+    "  line = shapeLine;\n"
+    "  gl_Position = mvp * vec4(vertexPosition, 1.0);\n"
+    "}\n";
+
+static const char *CARD_BATCH_FRAGMENT_SHADER =
+    "#version 330\n"
+    "in vec2 point;\n"
+    "in vec4 size;\n" // Half width and height, radius, outline width
+    "in vec4 fill;\n"
+    "in vec4 line;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "  vec2 q = abs(point) - size.xy + size.z;\n"
+    "  float d = min(max(q.x, q.y), 0.0) + length(max(q, 0.0)) - size.z;\n"
+    "  float pixel = max(fwidth(d), 0.0001);\n"
+    "  float outer = clamp(0.5 - d / pixel, 0.0, 1.0);\n"
+    "  float inner = clamp(0.5 - (d + size.w) / pixel, 0.0, 1.0);\n"
+    "  vec4 color = vec4(line.rgb * line.a, line.a) * (outer - inner) + vec4(fill.rgb * fill.a, fill.a) * inner;\n"
+    "  if (color.a <= 0.0) discard;\n"
+    "  finalColor = vec4(color.rgb / color.a, color.a);\n"
+    "}\n";
+
+static void card_batch_attribute(int location, int size, int type, bool normalized, size_t offset)
+{
+  if (location < 0)
+    return; // Not used by the shader, compiled out
+  rlSetVertexAttribute(location, size, type, normalized, sizeof(mesh_vertex_t), offset);
+  rlEnableVertexAttribute(location);
+}
+
+static void card_batch_attributes(const card_batch_t *batch)
+{
+  card_batch_attribute(batch->locations[0], 2, RL_FLOAT, false, offsetof(mesh_vertex_t, x));
+  card_batch_attribute(batch->locations[1], 2, RL_FLOAT, false, offsetof(mesh_vertex_t, u));
+  card_batch_attribute(batch->locations[2], 4, RL_FLOAT, false, offsetof(mesh_vertex_t, half_width));
+  card_batch_attribute(batch->locations[3], 4, RL_UNSIGNED_BYTE, true, offsetof(mesh_vertex_t, fill));
+  card_batch_attribute(batch->locations[4], 4, RL_UNSIGNED_BYTE, true, offsetof(mesh_vertex_t, line));
+}
+
+card_batch_t *card_batch_create(int slots)
+{
+  card_batch_t *batch = (card_batch_t *)malloc(sizeof(card_batch_t));
+  if (!batch)
+    return NULL;
+
+  batch->mesh = card_mesh_create(slots);
+  if (!batch->mesh)
+  {
+    free(batch);
+    return NULL;
+  }
+  batch->vao = 0;
+  batch->vbo = 0;
+
+  // raylib hands back its default shader when ours doesn't compile, on a GL
+  // older than 3.3. The cards then go through raylib's shapes instead.
+  batch->shader = rlLoadShaderCode(CARD_BATCH_VERTEX_SHADER, CARD_BATCH_FRAGMENT_SHADER);
+  if (batch->shader == rlGetShaderIdDefault())
+    batch->shader = 0;
+  if (batch->shader == 0)
+  {
+    TraceLog(LOG_WARNING, "Failed to load the card shader, drawing cards with raylib shapes");
+    return batch;
+  }
+
+  batch->mvp = rlGetLocationUniform(batch->shader, "mvp");
+  batch->locations[0] = rlGetLocationAttrib(batch->shader, "vertexPosition");
+  batch->locations[1] = rlGetLocationAttrib(batch->shader, "shapePoint");
+  batch->locations[2] = rlGetLocationAttrib(batch->shader, "shapeSize");
+  batch->locations[3] = rlGetLocationAttrib(batch->shader, "vertexColor");
+  batch->locations[4] = rlGetLocationAttrib(batch->shader, "shapeLine");
+
+  batch->vao = rlLoadVertexArray();
+  rlEnableVertexArray(batch->vao);
+  batch->vbo = rlLoadVertexBuffer(batch->mesh->vertices, slots * CARD_MESH_VERTICES * sizeof(mesh_vertex_t), true);
+  card_batch_attributes(batch);
+  rlDisableVertexArray();
+  return batch;
+}
+
+void card_batch_destroy(card_batch_t *batch)
+{
+  if (batch == NULL)
+    return;
+
+  if (batch->shader != 0)
+  {
+    rlUnloadVertexArray(batch->vao);
+    rlUnloadVertexBuffer(batch->vbo);
+    rlUnloadShaderProgram(batch->shader);
+  }
+  card_mesh_destroy(batch->mesh);
+  free(batch);
+}
+
+// Each quad's rounded rect as the cards were drawn before the shader, the
+// outline around the inner rect. Aliased, there's no MSAA to smooth it.
+static void card_batch_draw_shapes(const card_batch_t *batch, int offset, int count)
+{
+  for (int i = offset; i < offset + count; i += 6)
+  {
+    const mesh_vertex_t *corner = &batch->mesh->vertices[i];
+    if (corner->fill.a == 0 && corner->line.a == 0)
+      continue;
+
+    float width = corner->line_width;
+    Rectangle inner = {corner->x - corner->u - corner->half_width + width,
+                       corner->y - corner->v - corner->half_height + width,
+                       2 * (corner->half_width - width),
+                       2 * (corner->half_height - width)};
+    float shorter = inner.width < inner.height ? inner.width : inner.height;
+    float roundness = corner->radius > 0 && shorter > 0 ? 2 * (corner->radius - width) / shorter : 0;
+    Color fill = {corner->fill.r, corner->fill.g, corner->fill.b, corner->fill.a};
+    Color line = {corner->line.r, corner->line.g, corner->line.b, corner->line.a};
+    DrawRectangleRounded(inner, roundness, 8, fill);
+    if (width > 0)
+      DrawRectangleRoundedLinesEx(inner, roundness, 8, width, line);
+  }
+}
+
+void card_batch_draw(card_batch_t *batch, int first, int last)
+{
+  int runs[4];
+  int run_count = card_mesh_runs(batch->mesh, first, last, runs);
+  if (batch->shader == 0)
+  {
+    for (int i = 0; i < run_count; i++)
+    {
+      card_batch_draw_shapes(batch, runs[2 * i], runs[2 * i + 1]);
+    }
+    return;
+  }
+
+  rlDrawRenderBatchActive();
+
+  int first_vertex, count;
+  while (card_mesh_take_dirty(batch->mesh, &first_vertex, &count))
+  {
+    rlUpdateVertexBuffer(batch->vbo, batch->mesh->vertices + first_vertex, count * sizeof(mesh_vertex_t),
+                         first_vertex * sizeof(mesh_vertex_t));
+  }
+
+  // What raylib's batch would use, with the pushed transform it applies to
+  // its vertices on the CPU folded in
+  Matrix mvp = MatrixMultiply(MatrixMultiply(rlGetMatrixTransform(), rlGetMatrixModelview()), rlGetMatrixProjection());
+  rlEnableShader(batch->shader);
+  rlSetUniformMatrix(batch->mvp, mvp);
+
+  if (!rlEnableVertexArray(batch->vao))
+  {
+    rlEnableVertexBuffer(batch->vbo); // No vertex arrays on this GL, point at the buffer each time
+    card_batch_attributes(batch);
+  }
+  for (int i = 0; i < run_count; i++)
+  {
+    rlDrawVertexArray(runs[2 * i], runs[2 * i + 1]);
+  }
+
+  rlDisableVertexArray();
+  rlDisableVertexBuffer();
+  rlDisableShader();
+}
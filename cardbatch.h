@@ -0,0 +1,32 @@
+#ifndef CARDBATCH_H
+#define CARDBATCH_H
+
+#include "cardmesh.h"
+
+#define CARD_BATCH_SLOTS 256 // Cards whose triangles are kept, far more than a few tiles hold
+
+// Card quads in one vertex buffer on the GPU, mirroring a card_mesh_t, and
+// the shader that draws their rounded rects. Only the slots built since the
+// last draw are uploaded again.
+typedef struct card_batch
+{
+  card_mesh_t *mesh;
+  unsigned int vao;
+  unsigned int vbo;
+  unsigned int shader; // 0 if it didn't load, raylib's shapes draw the cards then
+  int mvp;          // Uniform location
+  int locations[5]; // Of position, shape point, size, fill and line
+} card_batch_t;
+
+// Needs the window open, the buffer and shader are made right away. The
+// shader needs GLSL 330, without it the cards are drawn with raylib's rounded
+// rectangles. NULL only when out of memory.
+card_batch_t *card_batch_create(int slots);
+void card_batch_destroy(card_batch_t *batch);
+
+// Draws cards first to last with the current transform in one call, two when
+// their slots wrap. Anything raylib has queued is drawn first, so the cards
+// go over it.
+void card_batch_draw(card_batch_t *batch, int first, int last);
+
+#endif // CARDBATCH_H
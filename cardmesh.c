@@ -0,0 +1,198 @@
+#include <stdlib.h>
+#include <string.h>
+#include "cardmesh.h"
+
+card_mesh_t *card_mesh_create(int slots)
+{
+  card_mesh_t *mesh = (card_mesh_t *)malloc(sizeof(card_mesh_t));
+  if (!mesh)
+    return NULL;
+
+  mesh->slots = slots;
+  mesh->vertices = (mesh_vertex_t *)calloc((size_t)slots * CARD_MESH_VERTICES, sizeof(mesh_vertex_t));
+  mesh->cards = (int *)malloc(sizeof(int) * slots);
+  mesh->states = (unsigned int *)malloc(sizeof(unsigned int) * slots);
+  mesh->dirty = (bool *)calloc(slots, sizeof(bool));
+  if (!mesh->vertices || !mesh->cards || !mesh->states || !mesh->dirty)
+  {
+    card_mesh_destroy(mesh);
+    return NULL;
+  }
+  card_mesh_clear(mesh);
+  return mesh;
+}
+
+void card_mesh_destroy(card_mesh_t *mesh)
+{
+  if (mesh == NULL)
+    return;
+
+  free(mesh->vertices);
+  free(mesh->cards);
+  free(mesh->states);
+  free(mesh->dirty);
+  free(mesh);
+}
+
+void card_mesh_clear(card_mesh_t *mesh)
+{
+  for (int i = 0; i < mesh->slots; i++)
+  {
+    mesh->cards[i] = -1;
+    mesh->dirty[i] = false;
+  }
+  mesh->dirty_first = 0;
+  mesh->dirty_end = 0;
+}
+
+void card_mesh_forget(card_mesh_t *mesh, int first)
+{
+  for (int i = 0; i < mesh->slots; i++)
+  {
+    if (mesh->cards[i] >= first)
+      mesh->cards[i] = -1;
+  }
+}
+
+bool card_mesh_holds(const card_mesh_t *mesh, int card, unsigned int state)
+{
+  int slot = card % mesh->slots;
+  return mesh->cards[slot] == card && mesh->states[slot] == state;
+}
+
+//------------------------------------------------------------------------------
+// Quads
+//------------------------------------------------------------------------------
+
+static float mesh_radius(mesh_rect_t rect, float roundness)
+{
+  return (rect.width > rect.height ? rect.height : rect.width) * roundness / 2;
+}
+
+// Top over bottom, as blending would draw them
+static mesh_color_t mesh_over(mesh_color_t top, mesh_color_t bottom)
+{
+  float a = top.a / 255.0f;
+  float b = bottom.a / 255.0f * (1 - a);
+  float alpha = a + b;
+  if (alpha <= 0)
+    return (mesh_color_t){0};
+  return (mesh_color_t){(unsigned char)((top.r * a + bottom.r * b) / alpha + 0.5f),
+                        (unsigned char)((top.g * a + bottom.g * b) / alpha + 0.5f),
+                        (unsigned char)((top.b * a + bottom.b * b) / alpha + 0.5f),
+                        (unsigned char)(alpha * 255 + 0.5f)};
+}
+
+// Rounded rect with an outline of width outside it, as raylib's
+// DrawRectangleRounded and DrawRectangleRoundedLinesEx drew them together.
+// The shader takes the outer edge, so rect and radius grow by the outline.
+// Two counter-clockwise triangles on screen, y down, like raylib's own.
+static mesh_vertex_t *mesh_shape(mesh_vertex_t *v, mesh_rect_t rect, float roundness, float width,
+                                 mesh_color_t fill, mesh_color_t line)
+{
+  if (rect.width <= 0 || rect.height <= 0 || (fill.a == 0 && (line.a == 0 || width <= 0)))
+  {
+    memset(v, 0, sizeof(mesh_vertex_t) * 6); // Degenerate, nothing is drawn there
+    return v + 6;
+  }
+  if (width < 0)
+    width = 0;
+
+  float radius = mesh_radius(rect, roundness);
+  if (radius <= 0)
+    width = 0; // raylib left the outline out with no corners to go round
+  float half_width = rect.width / 2 + width;
+  float half_height = rect.height / 2 + width;
+  float x = rect.x + rect.width / 2;
+  float y = rect.y + rect.height / 2;
+  float u = half_width + CARD_MESH_FRINGE;
+  float w = half_height + CARD_MESH_FRINGE;
+
+  mesh_vertex_t corner = {0, 0, 0, 0, half_width, half_height, radius > 0 ? radius + width : 0, width, fill, line};
+  float corners[6][2] = {{-u, -w}, {-u, w}, {u, w}, {-u, -w}, {u, w}, {u, -w}};
+  for (int i = 0; i < 6; i++)
+  {
+    corner.u = corners[i][0];
+    corner.v = corners[i][1];
+    corner.x = x + corner.u;
+    corner.y = y + corner.v;
+    v[i] = corner;
+  }
+  return v + 6;
+}
+
+void card_mesh_set(card_mesh_t *mesh, int card, unsigned int state, const mesh_card_t *shape)
+{
+  int slot = card % mesh->slots;
+  mesh->cards[slot] = card;
+  mesh->states[slot] = state;
+
+  mesh_vertex_t *v = mesh->vertices + (size_t)slot * CARD_MESH_VERTICES;
+  mesh_rect_t progress = shape->rect;
+  progress.width = shape->progress;
+  v = mesh_shape(v, shape->rect, shape->roundness, shape->line_width, mesh_over(shape->shade, shape->fill), shape->line);
+  v = mesh_shape(v, progress, shape->roundness, 0, shape->progress_color, (mesh_color_t){0});
+  mesh_shape(v, shape->marker, shape->roundness, shape->marker_line_width, shape->marker_fill, shape->marker_line);
+
+  mesh->dirty[slot] = true;
+  if (mesh->dirty_end <= mesh->dirty_first)
+  {
+    mesh->dirty_first = slot;
+    mesh->dirty_end = slot + 1;
+  }
+  else
+  {
+    if (slot < mesh->dirty_first)
+      mesh->dirty_first = slot;
+    if (slot + 1 > mesh->dirty_end)
+      mesh->dirty_end = slot + 1;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Drawing
+//------------------------------------------------------------------------------
+
+int card_mesh_runs(const card_mesh_t *mesh, int first, int last, int runs[4])
+{
+  int first_slot = first % mesh->slots;
+  int last_slot = last % mesh->slots;
+  if (first_slot <= last_slot)
+  {
+    runs[0] = first_slot * CARD_MESH_VERTICES;
+    runs[1] = (last_slot - first_slot + 1) * CARD_MESH_VERTICES;
+    return 1;
+  }
+
+  runs[0] = first_slot * CARD_MESH_VERTICES;
+  runs[1] = (mesh->slots - first_slot) * CARD_MESH_VERTICES;
+  runs[2] = 0;
+  runs[3] = (last_slot + 1) * CARD_MESH_VERTICES;
+  return 2;
+}
+
+bool card_mesh_take_dirty(card_mesh_t *mesh, int *first_vertex, int *count)
+{
+  // Cards far apart, the current one and the one under the mouse, go up as
+  // two runs rather than everything between them
+  int first = mesh->dirty_first;
+  while (first < mesh->dirty_end && !mesh->dirty[first])
+    first++;
+  if (first >= mesh->dirty_end)
+  {
+    mesh->dirty_first = 0;
+    mesh->dirty_end = 0;
+    return false;
+  }
+
+  int end = first;
+  while (end < mesh->dirty_end && mesh->dirty[end])
+  {
+    mesh->dirty[end] = false;
+    end++;
+  }
+  mesh->dirty_first = end;
+  *first_vertex = first * CARD_MESH_VERTICES;
+  *count = (end - first) * CARD_MESH_VERTICES;
+  return true;
+}
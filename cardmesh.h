@@ -0,0 +1,94 @@
+#ifndef CARDMESH_H
+#define CARDMESH_H
+
+#include <stdbool.h>
+
+// Each card is three quads, its body with the outline, the progress bar and
+// the current marker. Always all three so every card takes the same room and
+// its vertices can be found from its slot.
+#define CARD_MESH_SHAPES 3
+#define CARD_MESH_VERTICES (CARD_MESH_SHAPES * 6)
+
+#define CARD_MESH_FRINGE 1.0f // Quads reach this far past a shape for its antialiased edge
+
+typedef struct mesh_color
+{
+  unsigned char r, g, b, a;
+} mesh_color_t;
+
+typedef struct mesh_rect
+{
+  float x, y, width, height;
+} mesh_rect_t;
+
+// Corner of a quad holding one rounded rectangle, which the card shader
+// draws from its distance to the edge. Everything but the position is the
+// same at all four corners.
+typedef struct mesh_vertex
+{
+  float x, y;
+  float u, v;                    // From the rectangle's center
+  float half_width, half_height; // Of the rectangle, outline included
+  float radius, line_width;      // Outer corner radius, outline inside that edge
+  mesh_color_t fill;
+  mesh_color_t line;
+} mesh_vertex_t;
+
+// Shapes of one card in the order they're drawn. A shape with no width or a
+// transparent color is left out.
+typedef struct mesh_card
+{
+  mesh_rect_t rect;
+  float roundness; // Of every rounded shape, as DrawRectangleRounded takes it
+  mesh_color_t fill;
+  mesh_color_t shade; // Over the fill, for hover
+  float line_width;   // Outline, drawn outside rect
+  mesh_color_t line;
+  float progress; // Width of the bar from the left edge
+  mesh_color_t progress_color;
+  mesh_rect_t marker; // Current marker, outline then fill
+  float marker_line_width;
+  mesh_color_t marker_line;
+  mesh_color_t marker_fill;
+} mesh_card_t;
+
+// Quads of a run of cards, built once and kept. Card i lives in slot
+// i % slots and is only built again when the state it was built for
+// changes or another card takes the slot. Free of raylib, like fbox, the
+// owner uploads what changed and draws the slots.
+typedef struct card_mesh
+{
+  mesh_vertex_t *vertices; // CARD_MESH_VERTICES for each slot
+  int slots;
+  int *cards;           // Card each slot holds, -1 for none
+  unsigned int *states; // State it was built for
+  bool *dirty;          // Written since card_mesh_take_dirty took it
+  int dirty_first;      // Dirty slots are all within these,
+  int dirty_end;        // none when end <= first
+} card_mesh_t;
+
+card_mesh_t *card_mesh_create(int slots);
+void card_mesh_destroy(card_mesh_t *mesh);
+
+// Forgets every slot, for when card numbers or positions mean something else
+void card_mesh_clear(card_mesh_t *mesh);
+
+// Forgets the slots of card first and every card after it, for when those
+// show other items now
+void card_mesh_forget(card_mesh_t *mesh, int first);
+
+// Whether card's slot already holds its quads for state
+bool card_mesh_holds(const card_mesh_t *mesh, int card, unsigned int state);
+
+// Builds card's quads into its slot
+void card_mesh_set(card_mesh_t *mesh, int card, unsigned int state, const mesh_card_t *shape);
+
+// Vertex runs covering cards first to last, as offset and count pairs. Two
+// when the slots wrap around, first to last must fit in the slots.
+int card_mesh_runs(const card_mesh_t *mesh, int first, int last, int runs[4]);
+
+// Next run of slots written since they were last taken, as vertices. False
+// once there are none, call until then to upload every change.
+bool card_mesh_take_dirty(card_mesh_t *mesh, int *first_vertex, int *count);
+
+#endif // CARDMESH_H
@@ -1,3 +1,4 @@
+#include <pthread.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -5,6 +6,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include "data.h"
+#include "tzcache.h"
 
 #ifdef _WIN32
 #define _CRT_SECURE_NO_WARNINGS // No warnings about localtime_s
@@ -72,6 +74,8 @@ schedule_t *create_schedule()
   schedule->count = 0;
   schedule->capacity = 10;
   schedule->current_time = time(NULL);
+  schedule->date = date_today();
+  schedule->version = 0;
   return schedule;
 }
 
@@ -82,6 +86,7 @@ void add_item(schedule_t *schedule, schedule_item_t item)
     resize_schedule(schedule, schedule->capacity * 2);
   }
   schedule->items[schedule->count++] = item;
+  schedule->version++;
 }
 
 void remove_item(schedule_t *schedule, int index)
@@ -91,6 +96,7 @@ void remove_item(schedule_t *schedule, int index)
     schedule->items[i] = schedule->items[i + 1];
   }
   schedule->count--;
+  schedule->version++;
 }
 
 void resize_schedule(schedule_t *schedule, int new_size)
@@ -105,86 +111,128 @@ void destroy_schedule(schedule_t *schedule)
   free(schedule);
 }
 
+int date_from_ymd(int year, int month, int mday)
+{
+  // Days from civil, shifting the year to start in March so leap days land at
+  // the end of it.
+  year -= month <= 2;
+  int era = (year >= 0 ? year : year - 399) / 400;
+  int yoe = year - era * 400;
+  int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + mday - 1;
+  int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+void date_to_ymd(int date, int *year, int *month, int *mday)
+{
+  date += 719468;
+  int era = (date >= 0 ? date : date - 146096) / 146097;
+  int doe = date - era * 146097;
+  int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int mp = (5 * doy + 2) / 153;
+  int d = doy - (153 * mp + 2) / 5 + 1;
+  int m = mp < 10 ? mp + 3 : mp - 9;
+
+  *year = yoe + era * 400 + (m <= 2);
+  *month = m;
+  *mday = d;
+}
+
+int date_weekday(int date)
+{
+  // 1970-01-01 was a thursday
+  return date >= -4 ? (date + 4) % 7 : (date + 5) % 7 + 6;
+}
+
+int date_today(void)
+{
+  return tzcache_today();
+}
+
 time_t make_time(int hour, int min)
 {
-  time_t now = time(NULL);
-  struct tm today;
-#ifdef _WIN32
-  localtime_s(&today, &now);
-#else
-  localtime_r(&now, &today);
-#endif
-  today.tm_hour = hour;
-  today.tm_min = min;
-  today.tm_sec = 0;
-  return mktime(&today);
+  return make_date_time(date_today(), hour, min);
 }
 
-char *format_time(time_t time)
+time_t make_date_time(int date, int hour, int min)
 {
-  struct tm tm;
-  localtime_r(&time, &tm);
-  char *time_str = (char *)malloc(100);
-  sprintf(time_str, "%02d:%02d", tm.tm_hour, tm.tm_min);
-  return time_str;
+  return tzcache_make(date, hour * 60 + min);
 }
 
-char *format_time_12hr(time_t time)
+#define MINUTES_PER_DAY 1440
+
+static char time_labels[MINUTES_PER_DAY][6];
+static char time_labels_12hr[MINUTES_PER_DAY][FORMAT_TIME_SIZE];
+static pthread_once_t time_labels_once = PTHREAD_ONCE_INIT;
+
+// The prefetch thread formats times too, pthread_once makes sure the tables
+// are built once and fully before anyone reads them
+static void build_time_labels(void)
 {
-  struct tm tm;
-  localtime_r(&time, &tm);
-  char *time_str = (char *)malloc(100);
-  sprintf(time_str, "%02d:%02d %s", tm.tm_hour % 12 == 0 ? 12 : tm.tm_hour % 12, tm.tm_min, tm.tm_hour >= 12 ? "PM" : "AM");
-  return time_str;
+  for (int minute = 0; minute < MINUTES_PER_DAY; minute++)
+  {
+    int hour = minute / 60;
+    snprintf(time_labels[minute], sizeof(time_labels[minute]), "%02d:%02d", hour, minute % 60);
+    snprintf(time_labels_12hr[minute], sizeof(time_labels_12hr[minute]), "%02d:%02d %s",
+             hour % 12 == 0 ? 12 : hour % 12, minute % 60, hour >= 12 ? "PM" : "AM");
+  }
 }
 
-char *format_duration(time_t start, time_t end)
+void format_init(void)
 {
-  char *duration_str = (char *)malloc(100);
-  sprintf(duration_str, "%s - %s", format_time(start), format_time(end));
-  return duration_str;
+  pthread_once(&time_labels_once, build_time_labels);
 }
 
-char *format_duration_12hr(time_t start, time_t end)
+static int minute_of_day(time_t time)
 {
-  char *start_str = format_time_12hr(start);
-  char *end_str = format_time_12hr(end);
-  char *duration_str = (char *)malloc(strlen(start_str) + strlen(end_str) + 4);
-  sprintf(duration_str, "%s - %s", start_str, end_str);
-  free_formatted_time(start_str);
-  free_formatted_time(end_str);
-  return duration_str;
+  int minute;
+  format_init();
+  tzcache_split(time, NULL, &minute);
+  return minute;
 }
 
-char *format_date(time_t date)
+const char *format_time(time_t time)
 {
-  struct tm tm;
-  localtime_r(&date, &tm);
-  char *date_str = (char *)malloc(100);
-  sprintf(date_str, "%02d.%02d.%04d", tm.tm_mday, tm.tm_mon + 1, tm.tm_year + 1900);
-  return date_str;
+  return time_labels[minute_of_day(time)];
 }
 
-#ifdef _WIN32
-static inline struct tm *localtime_r(const time_t *timep, struct tm *result)
+const char *format_time_12hr(time_t time)
 {
-  localtime_s(result, timep);
-  return result;
+  return time_labels_12hr[minute_of_day(time)];
 }
-#endif
 
-void free_formatted_time(char *time_str)
+// Writes "<start> - <end>" into buffer, truncating to fit
+static char *join_range(const char *start, const char *end, char *buffer, size_t size)
 {
-  if (time_str != NULL)
+  size_t used = 0;
+  const char *parts[] = {start, " - ", end};
+  for (int i = 0; i < 3; i++)
   {
-    free(time_str);
+    size_t length = strlen(parts[i]);
+    if (used + length >= size)
+      length = size - used - 1;
+    memcpy(buffer + used, parts[i], length);
+    used += length;
   }
+  buffer[used] = '\0';
+  return buffer;
 }
 
-void free_formatted_duration(char *duration_str)
+char *format_duration(time_t start, time_t end, char *buffer, size_t size)
 {
-  if (duration_str != NULL)
-  {
-    free(duration_str);
-  }
-}
\ No newline at end of file
+  return join_range(format_time(start), format_time(end), buffer, size);
+}
+
+char *format_duration_12hr(time_t start, time_t end, char *buffer, size_t size)
+{
+  return join_range(format_time_12hr(start), format_time_12hr(end), buffer, size);
+}
+
+char *format_date(time_t date, char *buffer, size_t size)
+{
+  int year, month, mday;
+  date_to_ymd(tzcache_date(date), &year, &month, &mday);
+  snprintf(buffer, size, "%02d.%02d.%04d", mday, month, year);
+  return buffer;
+}
@@ -7,6 +7,7 @@
 
 #include <time.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 typedef enum schedule_item_type
 {
@@ -28,6 +29,8 @@ typedef struct schedule
   int count;
   int capacity;
   time_t current_time;
+  int date;             // Day the item times are resolved against, see date_from_ymd
+  unsigned int version; // Bumped whenever items change, for caches to compare
 } schedule_t;
 
 typedef struct schedule_iterator
@@ -50,14 +53,28 @@ void remove_item(schedule_t *schedule, int index);
 void resize_schedule(schedule_t *schedule, int new_size);
 void destroy_schedule(schedule_t *schedule);
 
+// Dates are whole days counted from 1970-01-01 on the proleptic Gregorian
+// calendar, so consecutive days are consecutive integers.
+int date_from_ymd(int year, int month, int mday);
+void date_to_ymd(int date, int *year, int *month, int *mday);
+int date_weekday(int date); // 0 = sunday
+int date_today(void);
+
 time_t make_time(int hour, int min);
-char *format_time(time_t time);
-char *format_time_12hr(time_t time);
-char *format_duration(time_t start, time_t end);
-char *format_duration_12hr(time_t start, time_t end);
-char *format_date(time_t date);
-
-void free_formatted_time(char *time_str);
-void free_formatted_duration(char *duration_str);
+time_t make_date_time(int date, int hour, int min);
+// Time labels come from tables of all 1440 minutes of the day, built once by
+// format_init (or on first use). The returned strings are static, and
+// durations and dates are written into the caller's buffer, so formatting
+// never allocates.
+#define FORMAT_TIME_SIZE 9      // "12:00 PM" and terminator
+#define FORMAT_DURATION_SIZE 20 // "12:00 PM - 12:00 PM" and terminator
+#define FORMAT_DATE_SIZE 16     // "31.12.2025" and terminator
+
+void format_init(void);
+const char *format_time(time_t time);
+const char *format_time_12hr(time_t time);
+char *format_duration(time_t start, time_t end, char *buffer, size_t size);
+char *format_duration_12hr(time_t start, time_t end, char *buffer, size_t size);
+char *format_date(time_t date, char *buffer, size_t size);
 
 #endif // DATA_H
\ No newline at end of file
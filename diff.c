@@ -0,0 +1,456 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "diff.h"
+
+#define DIFF_MAX_COST 1024
+
+typedef struct diff_side
+{
+  const schedule_item_t *items;
+  uint64_t *keys;
+  int count;
+} diff_side_t;
+
+// Chained hash table from item key to indices on one side
+typedef struct diff_table
+{
+  int *heads;
+  int *next;
+  uint64_t mask;
+} diff_table_t;
+
+//------------------------------------------------------------------------------
+// Keys
+//------------------------------------------------------------------------------
+
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t length)
+{
+  const unsigned char *bytes = (const unsigned char *)data;
+  for (size_t i = 0; i < length; i++)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL; // FNV-1a
+  }
+  return hash;
+}
+
+static uint64_t hash_title(const schedule_item_t *item)
+{
+  return hash_bytes(14695981039346656037ULL, item->title, strnlen(item->title, sizeof(item->title)));
+}
+
+static uint64_t hash_item(const schedule_item_t *item)
+{
+  uint64_t hash = hash_title(item);
+  hash = hash_bytes(hash, &item->start, sizeof(item->start));
+  return hash_bytes(hash, &item->end, sizeof(item->end));
+}
+
+static bool same_title(const schedule_item_t *a, const schedule_item_t *b)
+{
+  return strncmp(a->title, b->title, sizeof(a->title)) == 0;
+}
+
+static bool same_item(const schedule_item_t *a, const schedule_item_t *b)
+{
+  return a->start == b->start && a->end == b->end && same_title(a, b);
+}
+
+static bool keys_equal(diff_side_t *a, int i, diff_side_t *b, int j)
+{
+  return a->keys[i] == b->keys[j] && same_item(&a->items[i], &b->items[j]);
+}
+
+//------------------------------------------------------------------------------
+// Output
+//------------------------------------------------------------------------------
+
+static void diff_push(diff_t *diff, diff_op_type_t type, int old_index, int new_index)
+{
+  if (diff->count == diff->capacity)
+  {
+    diff->capacity = diff->capacity ? diff->capacity * 2 : 16;
+    diff->ops = (diff_op_t *)realloc(diff->ops, sizeof(diff_op_t) * diff->capacity);
+  }
+  diff->ops[diff->count++] = (diff_op_t){type, old_index, new_index};
+}
+
+//------------------------------------------------------------------------------
+// Hash table
+//------------------------------------------------------------------------------
+
+static void table_init(diff_table_t *table, int count)
+{
+  uint64_t size = 16;
+  while (size < (uint64_t)count * 2)
+    size <<= 1;
+
+  table->mask = size - 1;
+  table->heads = (int *)malloc(sizeof(int) * size);
+  table->next = (int *)malloc(sizeof(int) * (count > 0 ? count : 1));
+  memset(table->heads, -1, sizeof(int) * size);
+}
+
+// Inserts in reverse so each chain lists indices in ascending order
+static void table_fill(diff_table_t *table, const uint64_t *hashes, int count)
+{
+  for (int i = count - 1; i >= 0; i--)
+  {
+    uint64_t bucket = hashes[i] & table->mask;
+    table->next[i] = table->heads[bucket];
+    table->heads[bucket] = i;
+  }
+}
+
+static void table_free(diff_table_t *table)
+{
+  free(table->heads);
+  free(table->next);
+}
+
+//------------------------------------------------------------------------------
+// Myers
+//------------------------------------------------------------------------------
+
+// Finds the shortest edit script between from[x0..x1) and to[y0..y1), appending
+// the deleted old indices to dels and inserted new indices to ins. Returns
+// false without output if the edit distance exceeds DIFF_MAX_COST.
+static bool myers(diff_side_t *from, int x0, int x1,
+                  diff_side_t *to, int y0, int y1,
+                  int *dels, int *del_count, int *ins, int *ins_count)
+{
+  int n = x1 - x0;
+  int m = y1 - y0;
+  int max = n + m < DIFF_MAX_COST ? n + m : DIFF_MAX_COST;
+
+  // v[k] is the furthest x reached on diagonal k, trace keeps a copy of
+  // v[-d..d] after each round for the walk back
+  int *v = (int *)malloc(sizeof(int) * (2 * max + 3));
+  int *trace = (int *)malloc(sizeof(int) * (size_t)(max + 1) * (max + 1));
+  int offset = max + 1;
+  v[offset + 1] = 0;
+
+  int final_d = -1;
+  for (int d = 0; d <= max && final_d < 0; d++)
+  {
+    for (int k = -d; k <= d; k += 2)
+    {
+      int x;
+      if (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+        x = v[offset + k + 1];
+      else
+        x = v[offset + k - 1] + 1;
+
+      int y = x - k;
+      while (x < n && y < m && keys_equal(from, x0 + x, to, y0 + y))
+      {
+        x++;
+        y++;
+      }
+      v[offset + k] = x;
+
+      if (x >= n && y >= m)
+        final_d = d;
+    }
+    memcpy(&trace[(size_t)d * d], &v[offset - d], sizeof(int) * (2 * d + 1));
+  }
+
+  if (final_d < 0)
+  {
+    free(v);
+    free(trace);
+    return false;
+  }
+
+  // Walk back from (n, m), collecting edits in reverse
+  int first_del = *del_count;
+  int first_ins = *ins_count;
+  int x = n;
+  int y = m;
+  for (int d = final_d; d > 0; d--)
+  {
+    int *prev = &trace[(size_t)(d - 1) * (d - 1)] + (d - 1); // prev[k] for k in [-(d-1), d-1]
+    int k = x - y;
+    int prev_k;
+    if (k == -d || (k != d && prev[k - 1] < prev[k + 1]))
+      prev_k = k + 1;
+    else
+      prev_k = k - 1;
+
+    int prev_x = prev[prev_k];
+    int prev_y = prev_x - prev_k;
+    while (x > prev_x && y > prev_y)
+    {
+      x--;
+      y--;
+    }
+
+    if (x == prev_x)
+      ins[(*ins_count)++] = y0 + prev_y;
+    else
+      dels[(*del_count)++] = x0 + prev_x;
+
+    x = prev_x;
+    y = prev_y;
+  }
+
+  // Restore ascending order
+  for (int i = first_del, j = *del_count - 1; i < j; i++, j--)
+  {
+    int tmp = dels[i];
+    dels[i] = dels[j];
+    dels[j] = tmp;
+  }
+  for (int i = first_ins, j = *ins_count - 1; i < j; i++, j--)
+  {
+    int tmp = ins[i];
+    ins[i] = ins[j];
+    ins[j] = tmp;
+  }
+
+  free(v);
+  free(trace);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Fallback for large edit distances
+//------------------------------------------------------------------------------
+
+// Pairs every new item with the first unused identical old item, then keeps the
+// longest run of pairs that is increasing on both sides as unchanged. Pairs
+// outside that run become moves.
+static void match_by_key(diff_t *diff, diff_side_t *from, int x0, int x1,
+                         diff_side_t *to, int y0, int y1,
+                         int *dels, int *del_count, int *ins, int *ins_count)
+{
+  int n = x1 - x0;
+  int m = y1 - y0;
+  diff_table_t table;
+  table_init(&table, n);
+  table_fill(&table, from->keys + x0, n);
+
+  bool *used = (bool *)calloc(n > 0 ? n : 1, sizeof(bool));
+  int *pair_old = (int *)malloc(sizeof(int) * (m > 0 ? m : 1)); // -1 when unmatched
+  for (int j = 0; j < m; j++)
+  {
+    pair_old[j] = -1;
+    int *link = &table.heads[to->keys[y0 + j] & table.mask];
+    while (*link >= 0 && !keys_equal(from, x0 + *link, to, y0 + j))
+      link = &table.next[*link];
+    if (*link >= 0)
+    {
+      int i = *link;
+      *link = table.next[i]; // Unlink, chains only hold unused entries
+      used[i] = true;
+      pair_old[j] = i;
+    }
+  }
+
+  // Longest increasing subsequence of pair_old over new order
+  int *tails = (int *)malloc(sizeof(int) * (m > 0 ? m : 1)); // j of smallest tail per length
+  int *parent = (int *)malloc(sizeof(int) * (m > 0 ? m : 1));
+  int length = 0;
+  for (int j = 0; j < m; j++)
+  {
+    if (pair_old[j] < 0)
+      continue;
+
+    int lo = 0;
+    int hi = length;
+    while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+      if (pair_old[tails[mid]] < pair_old[j])
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    parent[j] = lo > 0 ? tails[lo - 1] : -1;
+    tails[lo] = j;
+    if (lo == length)
+      length++;
+  }
+
+  bool *in_order = (bool *)calloc(m > 0 ? m : 1, sizeof(bool));
+  for (int j = length > 0 ? tails[length - 1] : -1; j >= 0; j = parent[j])
+    in_order[j] = true;
+  diff->unchanged += length;
+
+  for (int j = 0; j < m; j++)
+  {
+    if (pair_old[j] < 0)
+      ins[(*ins_count)++] = y0 + j;
+    else if (!in_order[j])
+      diff_push(diff, DIFF_MOVE, x0 + pair_old[j], y0 + j);
+  }
+  for (int i = 0; i < n; i++)
+  {
+    if (!used[i])
+      dels[(*del_count)++] = x0 + i;
+  }
+
+  free(in_order);
+  free(parent);
+  free(tails);
+  free(pair_old);
+  free(used);
+  table_free(&table);
+}
+
+//------------------------------------------------------------------------------
+// Moves and modifications
+//------------------------------------------------------------------------------
+
+// Turns delete/insert pairs of the same item into moves, and of the same title
+// into modifications. Whatever is left stays a plain delete or insert.
+static void pair_edits(diff_t *diff, diff_side_t *from, diff_side_t *to,
+                       int *dels, int del_count, int *ins, int ins_count)
+{
+  diff_table_t table;
+  uint64_t *hashes = (uint64_t *)malloc(sizeof(uint64_t) * (del_count > 0 ? del_count : 1));
+  bool *used = (bool *)calloc(del_count > 0 ? del_count : 1, sizeof(bool));
+  bool *paired = (bool *)calloc(ins_count > 0 ? ins_count : 1, sizeof(bool));
+
+  // Exact matches first
+  for (int i = 0; i < del_count; i++)
+    hashes[i] = from->keys[dels[i]];
+  table_init(&table, del_count);
+  table_fill(&table, hashes, del_count);
+  for (int j = 0; j < ins_count; j++)
+  {
+    int *link = &table.heads[to->keys[ins[j]] & table.mask];
+    while (*link >= 0 && (used[*link] || !keys_equal(from, dels[*link], to, ins[j])))
+      link = &table.next[*link];
+    if (*link >= 0)
+    {
+      int i = *link;
+      *link = table.next[i];
+      used[i] = true;
+      paired[j] = true;
+      diff_push(diff, DIFF_MOVE, dels[i], ins[j]);
+    }
+  }
+  table_free(&table);
+
+  // Then same title
+  for (int i = 0; i < del_count; i++)
+    hashes[i] = hash_title(&from->items[dels[i]]);
+  table_init(&table, del_count);
+  table_fill(&table, hashes, del_count);
+  for (int j = 0; j < ins_count; j++)
+  {
+    if (paired[j])
+      continue;
+
+    const schedule_item_t *item = &to->items[ins[j]];
+    int *link = &table.heads[hash_title(item) & table.mask];
+    while (*link >= 0 && (used[*link] || !same_title(&from->items[dels[*link]], item)))
+      link = &table.next[*link];
+    if (*link >= 0)
+    {
+      int i = *link;
+      *link = table.next[i];
+      used[i] = true;
+      paired[j] = true;
+      diff_push(diff, DIFF_MODIFY, dels[i], ins[j]);
+    }
+  }
+  table_free(&table);
+
+  for (int i = 0; i < del_count; i++)
+  {
+    if (!used[i])
+      diff_push(diff, DIFF_DELETE, dels[i], -1);
+  }
+  for (int j = 0; j < ins_count; j++)
+  {
+    if (!paired[j])
+      diff_push(diff, DIFF_INSERT, -1, ins[j]);
+  }
+
+  free(paired);
+  free(used);
+  free(hashes);
+}
+
+//------------------------------------------------------------------------------
+// Entry points
+//------------------------------------------------------------------------------
+
+diff_t *diff_schedules(const schedule_t *from, const schedule_t *to)
+{
+  diff_t *diff = (diff_t *)calloc(1, sizeof(diff_t));
+  if (!diff)
+    return NULL;
+
+  diff_side_t a = {from->items, (uint64_t *)malloc(sizeof(uint64_t) * (from->count + 1)), from->count};
+  diff_side_t b = {to->items, (uint64_t *)malloc(sizeof(uint64_t) * (to->count + 1)), to->count};
+  for (int i = 0; i < a.count; i++)
+    a.keys[i] = hash_item(&a.items[i]);
+  for (int j = 0; j < b.count; j++)
+    b.keys[j] = hash_item(&b.items[j]);
+
+  // Common prefix and suffix never take part in the search
+  int x0 = 0;
+  int y0 = 0;
+  while (x0 < a.count && y0 < b.count && keys_equal(&a, x0, &b, y0))
+  {
+    x0++;
+    y0++;
+  }
+  int x1 = a.count;
+  int y1 = b.count;
+  while (x1 > x0 && y1 > y0 && keys_equal(&a, x1 - 1, &b, y1 - 1))
+  {
+    x1--;
+    y1--;
+  }
+
+  int *dels = (int *)malloc(sizeof(int) * (x1 - x0 + 1));
+  int *ins = (int *)malloc(sizeof(int) * (y1 - y0 + 1));
+  int del_count = 0;
+  int ins_count = 0;
+
+  diff->unchanged = x0 + (a.count - x1);
+  if (myers(&a, x0, x1, &b, y0, y1, dels, &del_count, ins, &ins_count))
+  {
+    diff->unchanged += (x1 - x0) - del_count;
+  }
+  else
+  {
+    match_by_key(diff, &a, x0, x1, &b, y0, y1, dels, &del_count, ins, &ins_count);
+  }
+
+  pair_edits(diff, &a, &b, dels, del_count, ins, ins_count);
+
+  free(dels);
+  free(ins);
+  free(a.keys);
+  free(b.keys);
+  return diff;
+}
+
+void diff_destroy(diff_t *diff)
+{
+  if (diff == NULL)
+    return;
+
+  free(diff->ops);
+  free(diff);
+}
+
+int diff_first_change(const diff_t *diff)
+{
+  // Items before the lowest index any op names were all matched in order
+  int first = -1;
+  for (int i = 0; i < diff->count; i++)
+  {
+    const diff_op_t *op = &diff->ops[i];
+    int index = op->old_index < 0 || (op->new_index >= 0 && op->new_index < op->old_index) ? op->new_index : op->old_index;
+    if (first < 0 || index < first)
+      first = index;
+  }
+  return first;
+}
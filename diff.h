@@ -0,0 +1,42 @@
+#ifndef DIFF_H
+#define DIFF_H
+
+#include "data.h"
+
+// Items are matched by (title, start, end). Items matched in order are left
+// out; everything else is reported as one of these operations.
+typedef enum diff_op_type
+{
+  DIFF_INSERT, // Only in the new schedule
+  DIFF_DELETE, // Only in the old schedule
+  DIFF_MOVE,   // Same item, different position relative to its neighbours
+  DIFF_MODIFY  // Same title, different times
+} diff_op_type_t;
+
+typedef struct diff_op
+{
+  diff_op_type_t type;
+  int old_index; // Index in the old schedule, -1 for inserts
+  int new_index; // Index in the new schedule, -1 for deletes
+} diff_op_t;
+
+typedef struct diff
+{
+  diff_op_t *ops;
+  int count;
+  int capacity;
+  int unchanged; // Items matched in order, not listed in ops
+} diff_t;
+
+// Myers' O((N+M)D) algorithm over the items left after trimming the common
+// prefix and suffix. Past an edit distance of DIFF_MAX_COST it switches to
+// matching items by key and keeping the longest in-order run, which is
+// O(n log n) no matter how different the two schedules are.
+diff_t *diff_schedules(const schedule_t *from, const schedule_t *to);
+void diff_destroy(diff_t *diff);
+
+// Position of the first item that differs, every item before it is the same in
+// both schedules. -1 when nothing changed.
+int diff_first_change(const diff_t *diff);
+
+#endif // DIFF_H
@@ -0,0 +1,486 @@
+#include <stdlib.h>
+#include <math.h>
+#include <stdbool.h>
+#include "fbox.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+// Creation and destruction
+//------------------------------------------------------------------------------
+
+fbox_context_t fbox_layout_create(fbox_rect_t bounds, fbox_direction_t direction, float scale_x, float scale_y)
+{
+  fbox_context_t ctx = {
+      .bounds = bounds,
+      .direction = direction,
+      .main_align = fbox_ALIGN_START,
+      .cross_align = fbox_ALIGN_START,
+      .gap = 0,
+      .padding_y = 0,
+      .padding_x = 0,
+      .expected_items = 1,
+      .content_height = 0,
+      .content_width = 0,
+      .size_mode = fbox_SIZE_FIXED,
+      .scale_x = scale_x,
+      .scale_y = scale_y,
+      .content_max = NULL,
+      .item_count = 0,
+      .current_pos = 0,
+      .main_sum = 0,
+      .rects = NULL,
+      .rect_capacity = 0,
+      .flex_count = 0};
+  return ctx;
+}
+
+fbox_context_t fbox_layout_nested(const fbox_context_t *parent, fbox_rect_t bounds)
+{
+  fbox_context_t ctx = {
+      .bounds = bounds,
+      .direction = parent->direction,
+      .scale_x = parent->scale_x,
+      .scale_y = parent->scale_y,
+      .content_max = parent->content_max};
+  return ctx;
+}
+
+void fbox_destroy(fbox_context_t *ctx)
+{
+  if (ctx == NULL)
+    return;
+
+  // Update the owner's content height if needed
+  if (ctx->content_max != NULL)
+  {
+    *ctx->content_max = fmaxf(*ctx->content_max, ctx->content_height);
+  }
+
+  // Reset counters
+  ctx->item_count = 0;
+  ctx->flex_count = 0;
+}
+
+//------------------------------------------------------------------------------
+// Configuration functions
+//------------------------------------------------------------------------------
+
+void fbox_set_direction(fbox_context_t *ctx, fbox_direction_t direction)
+{
+  ctx->direction = direction;
+}
+
+void fbox_set_main_align(fbox_context_t *ctx, fbox_align_t align)
+{
+  ctx->main_align = align;
+}
+
+void fbox_set_cross_align(fbox_context_t *ctx, fbox_align_t align)
+{
+  ctx->cross_align = align;
+}
+
+void fbox_set_gap(fbox_context_t *ctx, float gap)
+{
+  ctx->gap = gap * ctx->scale_y;
+}
+
+void fbox_set_padding(fbox_context_t *ctx, float padding)
+{
+  ctx->padding_x = padding * ctx->scale_x;
+  ctx->padding_y = padding * ctx->scale_y;
+}
+
+void fbox_set_padding_y(fbox_context_t *ctx, float padding)
+{
+  ctx->padding_y = padding * ctx->scale_y;
+}
+
+void fbox_set_padding_x(fbox_context_t *ctx, float padding)
+{
+  ctx->padding_x = padding * ctx->scale_x;
+}
+
+void fbox_set_expected_items(fbox_context_t *ctx, int count)
+{
+  ctx->expected_items = count;
+}
+
+void fbox_set_size_mode(fbox_context_t *ctx, fbox_size_mode_t mode)
+{
+  ctx->size_mode = mode;
+}
+
+bool fbox_set_flex_weights(fbox_context_t *ctx, float weights[])
+{
+  ctx->flex_count = ctx->expected_items < FBOX_MAX_WEIGHTS ? ctx->expected_items : FBOX_MAX_WEIGHTS;
+  for (int i = 0; i < ctx->flex_count; i++)
+  {
+    ctx->flex_weights[i] = weights[i];
+  }
+  return ctx->expected_items <= FBOX_MAX_WEIGHTS;
+}
+
+void fbox_set_storage(fbox_context_t *ctx, fbox_rect_t *rects, int capacity)
+{
+  ctx->rects = rects;
+  ctx->rect_capacity = capacity;
+}
+
+//------------------------------------------------------------------------------
+// Layout functions
+//------------------------------------------------------------------------------
+
+// Size an item ends up with once stretching and flex weights are applied
+static inline fbox_vec2_t fbox_resolve_size(fbox_context_t *ctx, fbox_vec2_t size, int index,
+                                            fbox_direction_t direction, fbox_size_mode_t size_mode)
+{
+  // Handle size stretching if enabled
+  fbox_vec2_t final_size = size;
+  if (size_mode == fbox_SIZE_STRETCH)
+  {
+    if (direction == fbox_DIRECTION_ROW && index < ctx->flex_count)
+    {
+      float available_width = ctx->bounds.width - (2 * ctx->padding_x);
+      final_size.x = available_width * ctx->flex_weights[index];
+      final_size.y = ctx->bounds.height - (2 * ctx->padding_y);
+    }
+    else
+    {
+      final_size.x = ctx->bounds.width - (2 * ctx->padding_x);
+    }
+  }
+
+  // Handle the case where the size is 0
+  if (final_size.x == 0)
+    final_size.x = 1;
+  if (final_size.y == 0)
+    final_size.y = 1;
+
+  return final_size;
+}
+
+// Offset of an item from the container edge along the cross axis
+static inline float fbox_cross_offset(fbox_context_t *ctx, fbox_vec2_t size, int index,
+                                      fbox_direction_t direction, fbox_align_t cross_align)
+{
+  if (direction == fbox_DIRECTION_ROW)
+  {
+    if (cross_align == fbox_ALIGN_CENTER)
+      return (ctx->bounds.height - size.y) / 2;
+    if (cross_align == fbox_ALIGN_END)
+      return ctx->bounds.height - size.y - ctx->padding_y;
+    if (cross_align == fbox_ALIGN_SPACE_BETWEEN)
+    {
+      float space = (ctx->bounds.height - size.y - (2 * ctx->padding_y)) / (ctx->expected_items - 1);
+      return ctx->padding_y + space * index;
+    }
+    return ctx->padding_y;
+  }
+
+  if (cross_align == fbox_ALIGN_CENTER)
+    return (ctx->bounds.width - size.x) / 2;
+  if (cross_align == fbox_ALIGN_END)
+    return ctx->bounds.width - size.x - ctx->padding_x;
+  return ctx->padding_x;
+}
+
+fbox_rect_t fbox_layout_next(fbox_context_t *ctx, fbox_vec2_t size)
+{
+  fbox_direction_t direction = ctx->direction;
+  fbox_align_t main_align = ctx->main_align;
+  fbox_align_t cross_align = ctx->cross_align;
+  fbox_size_mode_t size_mode = ctx->size_mode;
+
+  // Start of a run of items, inside the padding on the main axis like
+  // fbox_place
+  if (ctx->item_count == 0)
+  {
+    ctx->current_pos = direction == fbox_DIRECTION_ROW ? ctx->padding_x : ctx->padding_y;
+    ctx->main_sum = 0;
+  }
+
+  fbox_vec2_t final_size = fbox_resolve_size(ctx, size, ctx->item_count, direction, size_mode);
+
+  float x = ctx->bounds.x;
+  float y = ctx->bounds.y;
+
+  // Layout items in a row
+  if (direction == fbox_DIRECTION_ROW)
+  {
+    x += ctx->current_pos;
+
+    // Handle main-axis alignment
+    if (main_align == fbox_ALIGN_CENTER)
+    {
+      x += (ctx->bounds.width - final_size.x) / 2;
+    }
+    else if (main_align == fbox_ALIGN_END)
+    {
+      x += ctx->bounds.width - final_size.x - ctx->padding_x;
+    }
+    else if (main_align == fbox_ALIGN_SPACE_BETWEEN)
+    {
+      // Items placed so far are summed as they go, earlier items keep the
+      // position they were given
+      float total_items_width = ctx->main_sum + final_size.x;
+
+      // Calculate space between items
+      float space_between = 0;
+      if (ctx->expected_items > 1)
+      {
+        float available_space = ctx->bounds.width - total_items_width - (2 * ctx->padding_x);
+        space_between = available_space / (ctx->expected_items - 1);
+      }
+
+      x = ctx->bounds.x + ctx->padding_x + ctx->item_count * space_between + ctx->main_sum;
+    }
+
+    y += fbox_cross_offset(ctx, final_size, ctx->item_count, direction, cross_align);
+
+    ctx->current_pos += final_size.x;
+    ctx->main_sum += final_size.x;
+
+    if (ctx->item_count < ctx->expected_items - 1)
+    {
+      ctx->current_pos += ctx->gap;
+    }
+
+    if (ctx->item_count == ctx->expected_items - 1)
+    {
+      ctx->current_pos += ctx->padding_x;
+    }
+
+    ctx->content_width = ctx->current_pos;
+  }
+  // Layout items in a column
+  else
+  {
+    y += ctx->current_pos;
+    x += fbox_cross_offset(ctx, final_size, ctx->item_count, direction, cross_align);
+
+    ctx->current_pos += final_size.y;
+    ctx->main_sum += final_size.y;
+
+    if (ctx->item_count < ctx->expected_items - 1)
+    {
+      ctx->current_pos += ctx->gap;
+    }
+
+    if (ctx->item_count == ctx->expected_items - 1)
+    {
+      ctx->current_pos += ctx->padding_y;
+    }
+
+    ctx->content_height = ctx->current_pos;
+
+    // Track maximum width for column layout
+    if (final_size.x > ctx->content_width)
+    {
+      ctx->content_width = final_size.x;
+    }
+  }
+
+  fbox_rect_t result = {x, y, final_size.x, final_size.y};
+  if (ctx->item_count < ctx->rect_capacity)
+  {
+    ctx->rects[ctx->item_count] = result;
+  }
+
+  ctx->item_count++;
+
+  // Reset tracking after processing all items
+  if (ctx->item_count == ctx->expected_items)
+  {
+    ctx->item_count = 0;
+    ctx->current_pos = direction == fbox_DIRECTION_ROW ? ctx->padding_x : ctx->padding_y;
+    ctx->main_sum = 0;
+  }
+
+  return result;
+}
+
+int fbox_layout_measure(fbox_context_t *ctx, fbox_vec2_t size)
+{
+  if (ctx->item_count >= ctx->rect_capacity)
+    return -1;
+
+  fbox_vec2_t final_size = fbox_resolve_size(ctx, size, ctx->item_count, ctx->direction, ctx->size_mode);
+  ctx->rects[ctx->item_count] = (fbox_rect_t){0, 0, final_size.x, final_size.y};
+  return ctx->item_count++;
+}
+
+// Positions along a column for count items already sized in rects. Item i
+// goes to y + the heights and gaps of the items before it, and to
+// x + cross_a + cross_b * its width across. Returns the main axis advance
+// including a gap after the last item, widest item in cross_max.
+static float fbox_place_column(fbox_rect_t *rects, int count, float x, float y, float gap,
+                               float cross_a, float cross_b, float *cross_max)
+{
+  float start = y;
+  float widest = 0;
+  int i = 0;
+#if defined(__SSE2__)
+  // A rect is four floats, so four of them transpose into vectors of x, y,
+  // width and height, and y comes out of a prefix sum over the heights
+  __m128 gaps = _mm_set1_ps(gap);
+  __m128 offset = _mm_set1_ps(x + cross_a);
+  __m128 scale = _mm_set1_ps(cross_b);
+  __m128 next = _mm_set1_ps(y);
+  __m128 widths = _mm_setzero_ps();
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 r0 = _mm_loadu_ps(&rects[i].x);
+    __m128 r1 = _mm_loadu_ps(&rects[i + 1].x);
+    __m128 r2 = _mm_loadu_ps(&rects[i + 2].x);
+    __m128 r3 = _mm_loadu_ps(&rects[i + 3].x);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    __m128 step = _mm_add_ps(r3, gaps);
+    __m128 sum = _mm_add_ps(step, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(step), 4)));
+    sum = _mm_add_ps(sum, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(sum), 8)));
+
+    r0 = _mm_add_ps(offset, _mm_mul_ps(scale, r2));
+    r1 = _mm_add_ps(next, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(sum), 4)));
+    widths = _mm_max_ps(widths, r2);
+    next = _mm_add_ps(next, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 3, 3)));
+
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(&rects[i].x, r0);
+    _mm_storeu_ps(&rects[i + 1].x, r1);
+    _mm_storeu_ps(&rects[i + 2].x, r2);
+    _mm_storeu_ps(&rects[i + 3].x, r3);
+  }
+  y = _mm_cvtss_f32(next);
+  widths = _mm_max_ps(widths, _mm_shuffle_ps(widths, widths, _MM_SHUFFLE(1, 0, 3, 2)));
+  widths = _mm_max_ps(widths, _mm_shuffle_ps(widths, widths, _MM_SHUFFLE(2, 3, 0, 1)));
+  widest = _mm_cvtss_f32(widths);
+#endif
+  for (; i < count; i++)
+  {
+    rects[i].x = x + cross_a + cross_b * rects[i].width;
+    rects[i].y = y;
+    y += rects[i].height + gap;
+    widest = fmaxf(widest, rects[i].width);
+  }
+  *cross_max = widest;
+  return y - start;
+}
+
+// Places count items already sized in rects as one group, with main axis
+// alignment applied to the whole group
+static void fbox_place(fbox_context_t *ctx, fbox_rect_t *rects, int count)
+{
+  bool row = ctx->direction == fbox_DIRECTION_ROW;
+  float extent = row ? ctx->bounds.width : ctx->bounds.height;
+  float padding = row ? ctx->padding_x : ctx->padding_y;
+
+  // Whole group is known, so distribution is decided once up front. Start
+  // aligned groups don't need the total.
+  float gap = ctx->gap;
+  float pos = padding;
+  if (ctx->main_align != fbox_ALIGN_START)
+  {
+    float total = 0;
+    for (int i = 0; i < count; i++)
+    {
+      total += row ? rects[i].width : rects[i].height;
+    }
+
+    float free_space = extent - (2 * padding) - total - (count > 1 ? gap * (count - 1) : 0);
+    if (ctx->main_align == fbox_ALIGN_CENTER)
+    {
+      pos += free_space / 2;
+    }
+    else if (ctx->main_align == fbox_ALIGN_END)
+    {
+      pos += free_space;
+    }
+    else if (ctx->main_align == fbox_ALIGN_SPACE_BETWEEN && count > 1)
+    {
+      gap = (extent - (2 * padding) - total) / (count - 1);
+    }
+  }
+
+  float cross_max = 0;
+  if (row)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      fbox_rect_t *rect = &rects[i];
+      fbox_vec2_t size = {rect->width, rect->height};
+      rect->x = ctx->bounds.x + pos;
+      rect->y = ctx->bounds.y + fbox_cross_offset(ctx, size, i, ctx->direction, ctx->cross_align);
+      pos += rect->width;
+      cross_max = fmaxf(cross_max, rect->height);
+      if (i < count - 1)
+        pos += gap;
+    }
+  }
+  else
+  {
+    // Cross offset as a + b * width, see fbox_cross_offset
+    float cross_a = ctx->padding_x;
+    float cross_b = 0;
+    if (ctx->cross_align == fbox_ALIGN_CENTER)
+    {
+      cross_a = ctx->bounds.width / 2;
+      cross_b = -0.5f;
+    }
+    else if (ctx->cross_align == fbox_ALIGN_END)
+    {
+      cross_a = ctx->bounds.width - ctx->padding_x;
+      cross_b = -1;
+    }
+    pos += fbox_place_column(rects, count, ctx->bounds.x, ctx->bounds.y + pos, gap, cross_a, cross_b, &cross_max);
+    if (count > 0)
+      pos -= gap;
+  }
+  pos += padding;
+
+  if (row)
+  {
+    ctx->content_width = pos;
+  }
+  else
+  {
+    ctx->content_height = pos;
+    ctx->content_width = cross_max;
+  }
+}
+
+int fbox_arrange(fbox_context_t *ctx)
+{
+  int count = ctx->item_count;
+  fbox_place(ctx, ctx->rects, count);
+  ctx->item_count = 0;
+  return count;
+}
+
+int fbox_layout_batch(fbox_context_t *ctx, const fbox_vec2_t *sizes, fbox_rect_t *rects, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    fbox_vec2_t size = fbox_resolve_size(ctx, sizes[i], i, ctx->direction, ctx->size_mode);
+    rects[i] = (fbox_rect_t){0, 0, size.x, size.y};
+  }
+  fbox_place(ctx, rects, count);
+  return count;
+}
+
+//------------------------------------------------------------------------------
+// Layout information
+//------------------------------------------------------------------------------
+
+float fbox_get_content_height(fbox_context_t *ctx)
+{
+  return ctx->content_height;
+}
+
+float fbox_get_content_width(fbox_context_t *ctx)
+{
+  return ctx->content_width;
+}
\ No newline at end of file
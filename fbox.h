@@ -0,0 +1,123 @@
+#ifndef FBOX_H
+#define FBOX_H
+
+#include <stdbool.h>
+
+// Layout core behind flexbox.h. It has its own geometry types and takes the
+// scale as a parameter, so it builds and runs without raylib (see libfbox.a).
+
+// Flex weights stored inline in the context. A row with more items than this
+// can't be weighted: the items past the limit keep their own size and the row
+// no longer fills its width, so the setters report it.
+#define FBOX_MAX_WEIGHTS 8
+
+typedef struct fbox_vec2
+{
+  float x;
+  float y;
+} fbox_vec2_t;
+
+typedef struct fbox_rect
+{
+  float x;
+  float y;
+  float width;
+  float height;
+} fbox_rect_t;
+
+// Layout direction (horizontal or vertical)
+typedef enum fbox_direction
+{
+  fbox_DIRECTION_ROW,   // Items laid out in a row (left to right)
+  fbox_DIRECTION_COLUMN // Items laid out in a column (top to bottom)
+} fbox_direction_t;
+
+// Alignment options for main and cross axes
+typedef enum fbox_align
+{
+  fbox_ALIGN_START,         // Align items at start of container
+  fbox_ALIGN_CENTER,        // Center items in container
+  fbox_ALIGN_END,           // Align items at end of container
+  fbox_ALIGN_SPACE_BETWEEN, // Evenly space items with no space at ends
+} fbox_align_t;
+
+// Size modes for items
+typedef enum fbox_size_mode
+{
+  fbox_SIZE_FIXED,  // Use exact size provided
+  fbox_SIZE_STRETCH // Stretch to fill container (respecting padding)
+} fbox_size_mode_t;
+
+// Main flexbox context structure
+typedef struct fbox_context
+{
+  fbox_rect_t bounds;         // Container bounds
+  fbox_direction_t direction; // Layout direction
+  fbox_align_t main_align;    // Alignment along main axis
+  fbox_align_t cross_align;   // Alignment along cross axis
+  float gap;                  // Space between items
+  float padding_y;            // Space around container edges
+  float padding_x;            // Space around container edges
+  int expected_items;         // Number of items to layout
+  int item_count;             // Current number of items processed
+  float current_pos;          // Current position along main axis
+  float main_sum;             // Main axis size of the items processed so far
+  fbox_rect_t *rects;         // Caller storage receiving each item, may be NULL
+  int rect_capacity;          // Number of rectangles rects can hold
+  float content_height;       // Total height of content
+  float content_width;        // Total width of content
+  fbox_size_mode_t size_mode; // How items should be sized
+  float scale_x;              // Applied to gap and padding as they are set
+  float scale_y;
+  float *content_max;         // Raised to the content height on destroy, may be NULL
+  float flex_weights[FBOX_MAX_WEIGHTS];
+  int flex_count;             // Number of flex weights set, 0 for none
+} fbox_context_t;
+
+// Creation and destruction
+fbox_context_t fbox_layout_create(fbox_rect_t bounds, fbox_direction_t direction, float scale_x, float scale_y);
+fbox_context_t fbox_layout_nested(const fbox_context_t *parent, fbox_rect_t bounds);
+void fbox_destroy(fbox_context_t *ctx);
+
+// Configuration functions
+void fbox_set_direction(fbox_context_t *ctx, fbox_direction_t direction);
+void fbox_set_main_align(fbox_context_t *ctx, fbox_align_t align);
+void fbox_set_cross_align(fbox_context_t *ctx, fbox_align_t align);
+void fbox_set_gap(fbox_context_t *ctx, float gap);
+void fbox_set_padding(fbox_context_t *ctx, float padding);
+void fbox_set_padding_y(fbox_context_t *ctx, float padding);
+void fbox_set_padding_x(fbox_context_t *ctx, float padding);
+void fbox_set_expected_items(fbox_context_t *ctx, int count);
+void fbox_set_size_mode(fbox_context_t *ctx, fbox_size_mode_t mode);
+// One weight per expected item, set the expected items first. Returns false,
+// keeping the first FBOX_MAX_WEIGHTS, when there are more items than that.
+bool fbox_set_flex_weights(fbox_context_t *ctx, float weights[]);
+// Contiguous storage the laid out rectangles are also written to, in order.
+// The context never allocates, this is only for callers wanting them later.
+void fbox_set_storage(fbox_context_t *ctx, fbox_rect_t *rects, int capacity);
+
+// Layout information
+float fbox_get_content_height(fbox_context_t *ctx);
+float fbox_get_content_width(fbox_context_t *ctx);
+
+// Layout functions
+// Places one item as soon as it's known. Runs start inside padding_x in a row
+// and padding_y in a column, same as the two pass functions below, so start
+// aligned items land on the same rects either way.
+fbox_rect_t fbox_layout_next(fbox_context_t *ctx, fbox_vec2_t size);
+
+// Two pass layout, for when every item is known before drawing. Measure each
+// item into the storage set with fbox_set_storage, then arrange places them all
+// at once in a single pass, with main axis alignment applied to the whole
+// group. Returns the index of the item, or -1 when storage is full.
+int fbox_layout_measure(fbox_context_t *ctx, fbox_vec2_t size);
+// Resolves positions of the measured items in storage and returns how many
+// there were. The context is ready for another round afterwards.
+int fbox_arrange(fbox_context_t *ctx);
+// Both passes in one call: sizes count items and places them into rects, as
+// a group like fbox_arrange, without going through the context's storage.
+// Columns, the card list, are placed four at a time with SSE2 where it's
+// available. Returns count.
+int fbox_layout_batch(fbox_context_t *ctx, const fbox_vec2_t *sizes, fbox_rect_t *rects, int count);
+
+#endif // FBOX_H
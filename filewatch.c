@@ -0,0 +1,109 @@
+#include <stdlib.h>
+#include "filewatch.h"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h" // The GLFW raylib is built with, its empty event ends the wait
+
+#define FILE_WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE)
+
+static void *file_watch_thread(void *arg)
+{
+  file_watch_t *watch = (file_watch_t *)arg;
+  struct pollfd fds[2] = {{watch->fd, POLLIN, 0}, {watch->quit[0], POLLIN, 0}};
+  char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  for (;;)
+  {
+    if (poll(fds, 2, -1) < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    if (fds[1].revents)
+      break;
+
+    // One save is often several events, they all go in one wake
+    while (read(watch->fd, events, sizeof(events)) > 0)
+    {
+    }
+    atomic_store(&watch->changed, true);
+    glfwPostEmptyEvent();
+  }
+  return NULL;
+}
+
+file_watch_t *file_watch_create(void)
+{
+  file_watch_t *watch = (file_watch_t *)malloc(sizeof(file_watch_t));
+  if (!watch)
+    return NULL;
+
+  atomic_init(&watch->changed, false);
+  watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (watch->fd < 0)
+  {
+    free(watch);
+    return NULL;
+  }
+  if (pipe(watch->quit) != 0)
+  {
+    close(watch->fd);
+    free(watch);
+    return NULL;
+  }
+  if (pthread_create(&watch->thread, NULL, file_watch_thread, watch) != 0)
+  {
+    close(watch->quit[0]);
+    close(watch->quit[1]);
+    close(watch->fd);
+    free(watch);
+    return NULL;
+  }
+  return watch;
+}
+
+void file_watch_destroy(file_watch_t *watch)
+{
+  if (watch == NULL)
+    return;
+
+  close(watch->quit[1]); // Hangs up the pipe, which wakes the poll
+  pthread_join(watch->thread, NULL);
+  close(watch->quit[0]);
+  close(watch->fd);
+  free(watch);
+}
+
+bool file_watch_add(file_watch_t *watch, const char *folder)
+{
+  return inotify_add_watch(watch->fd, folder, FILE_WATCH_EVENTS) >= 0;
+}
+
+#else
+
+file_watch_t *file_watch_create(void)
+{
+  return NULL;
+}
+
+void file_watch_destroy(file_watch_t *watch)
+{
+}
+
+bool file_watch_add(file_watch_t *watch, const char *folder)
+{
+  return false;
+}
+
+#endif
+
+bool file_watch_take(file_watch_t *watch)
+{
+  return atomic_exchange(&watch->changed, false);
+}
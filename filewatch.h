@@ -0,0 +1,32 @@
+#ifndef FILEWATCH_H
+#define FILEWATCH_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+// Tells the main loop when schedule files change, so it can sleep instead of
+// checking their times every second. A thread blocks on inotify and posts an
+// empty event to GLFW when anything in a watched folder is written, moved or
+// deleted, ending the wait like idle_timer_t does at a deadline. Where there's
+// no inotify file_watch_create returns NULL, and the loop checks on an
+// interval as before.
+typedef struct file_watch
+{
+  pthread_t thread;
+  int fd;      // inotify
+  int quit[2]; // Pipe the thread also waits on, closed to stop it
+  atomic_bool changed;
+} file_watch_t;
+
+file_watch_t *file_watch_create(void);
+void file_watch_destroy(file_watch_t *watch);
+
+// Watches the files in folder, not its subfolders. False if it can't.
+bool file_watch_add(file_watch_t *watch, const char *folder);
+
+// Whether anything changed since the last call. What changed isn't kept, the
+// loop checks the files it shows for themselves.
+bool file_watch_take(file_watch_t *watch);
+
+#endif // FILEWATCH_H
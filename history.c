@@ -0,0 +1,495 @@
+#include <stdlib.h>
+#include <string.h>
+#include "history.h"
+
+struct history_node
+{
+  schedule_item_t item;
+  history_node_t *left;
+  history_node_t *right;
+  int size;   // Items in this subtree
+  int height; // AVL height
+  int refs;   // Versions and parent nodes pointing here
+};
+
+//------------------------------------------------------------------------------
+// Persistent tree
+//
+// Nodes are immutable once built. Functions take borrowed nodes and return a
+// new reference that the caller owns.
+//------------------------------------------------------------------------------
+
+static int node_size(history_node_t *node)
+{
+  return node ? node->size : 0;
+}
+
+static int node_height(history_node_t *node)
+{
+  return node ? node->height : 0;
+}
+
+static history_node_t *node_retain(history_node_t *node)
+{
+  if (node)
+    node->refs++;
+  return node;
+}
+
+static void node_release(history_node_t *node)
+{
+  while (node && --node->refs == 0)
+  {
+    history_node_t *right = node->right;
+    node_release(node->left);
+    free(node);
+    node = right; // Loop on one side to keep recursion shallow
+  }
+}
+
+static history_node_t *node_make(schedule_item_t item, history_node_t *left, history_node_t *right)
+{
+  history_node_t *node = (history_node_t *)malloc(sizeof(history_node_t));
+  node->item = item;
+  node->left = node_retain(left);
+  node->right = node_retain(right);
+  node->size = node_size(left) + node_size(right) + 1;
+  int hl = node_height(left);
+  int hr = node_height(right);
+  node->height = (hl > hr ? hl : hr) + 1;
+  node->refs = 1;
+  return node;
+}
+
+// Builds a node from parts whose heights differ by at most two, rotating into
+// fresh nodes so shared subtrees are never touched
+static history_node_t *node_balance(schedule_item_t item, history_node_t *left, history_node_t *right)
+{
+  int hl = node_height(left);
+  int hr = node_height(right);
+
+  if (hl > hr + 1)
+  {
+    if (node_height(left->left) >= node_height(left->right))
+    {
+      history_node_t *new_right = node_make(item, left->right, right);
+      history_node_t *result = node_make(left->item, left->left, new_right);
+      node_release(new_right);
+      return result;
+    }
+
+    history_node_t *pivot = left->right;
+    history_node_t *new_left = node_make(left->item, left->left, pivot->left);
+    history_node_t *new_right = node_make(item, pivot->right, right);
+    history_node_t *result = node_make(pivot->item, new_left, new_right);
+    node_release(new_left);
+    node_release(new_right);
+    return result;
+  }
+
+  if (hr > hl + 1)
+  {
+    if (node_height(right->right) >= node_height(right->left))
+    {
+      history_node_t *new_left = node_make(item, left, right->left);
+      history_node_t *result = node_make(right->item, new_left, right->right);
+      node_release(new_left);
+      return result;
+    }
+
+    history_node_t *pivot = right->left;
+    history_node_t *new_left = node_make(item, left, pivot->left);
+    history_node_t *new_right = node_make(right->item, pivot->right, right->right);
+    history_node_t *result = node_make(pivot->item, new_left, new_right);
+    node_release(new_left);
+    node_release(new_right);
+    return result;
+  }
+
+  return node_make(item, left, right);
+}
+
+static history_node_t *node_build(schedule_item_t *items, int count)
+{
+  if (count <= 0)
+    return NULL;
+
+  int mid = count / 2;
+  history_node_t *left = node_build(items, mid);
+  history_node_t *right = node_build(items + mid + 1, count - mid - 1);
+  history_node_t *node = node_make(items[mid], left, right);
+  node_release(left);
+  node_release(right);
+  return node;
+}
+
+static schedule_item_t *node_get(history_node_t *node, int index)
+{
+  while (node)
+  {
+    int left_size = node_size(node->left);
+    if (index < left_size)
+    {
+      node = node->left;
+    }
+    else if (index > left_size)
+    {
+      index -= left_size + 1;
+      node = node->right;
+    }
+    else
+    {
+      return &node->item;
+    }
+  }
+  return NULL;
+}
+
+// Copies count items from index first on into out, visiting only the nodes on
+// the way to them and the ones in range
+static void node_copy(history_node_t *node, int first, int count, schedule_item_t *out)
+{
+  while (node && count > 0)
+  {
+    int left_size = node_size(node->left);
+    if (first < left_size)
+    {
+      int taken = left_size - first < count ? left_size - first : count;
+      node_copy(node->left, first, taken, out);
+      out += taken;
+      count -= taken;
+      first = left_size;
+    }
+    if (count == 0)
+      return;
+    if (first == left_size)
+    {
+      *out++ = node->item;
+      count--;
+      first++;
+    }
+    first -= left_size + 1;
+    node = node->right; // Loop on the right to keep recursion shallow
+  }
+}
+
+static history_node_t *node_set(history_node_t *node, int index, schedule_item_t item)
+{
+  int left_size = node_size(node->left);
+  if (index == left_size)
+    return node_make(item, node->left, node->right);
+
+  history_node_t *child;
+  history_node_t *result;
+  if (index < left_size)
+  {
+    child = node_set(node->left, index, item);
+    result = node_make(node->item, child, node->right);
+  }
+  else
+  {
+    child = node_set(node->right, index - left_size - 1, item);
+    result = node_make(node->item, node->left, child);
+  }
+  node_release(child);
+  return result;
+}
+
+static history_node_t *node_insert(history_node_t *node, int index, schedule_item_t item)
+{
+  if (node == NULL)
+    return node_make(item, NULL, NULL);
+
+  history_node_t *child;
+  history_node_t *result;
+  int left_size = node_size(node->left);
+  if (index <= left_size)
+  {
+    child = node_insert(node->left, index, item);
+    result = node_balance(node->item, child, node->right);
+  }
+  else
+  {
+    child = node_insert(node->right, index - left_size - 1, item);
+    result = node_balance(node->item, node->left, child);
+  }
+  node_release(child);
+  return result;
+}
+
+static history_node_t *node_remove(history_node_t *node, int index)
+{
+  history_node_t *child;
+  history_node_t *result;
+  int left_size = node_size(node->left);
+
+  if (index < left_size)
+  {
+    child = node_remove(node->left, index);
+    result = node_balance(node->item, child, node->right);
+  }
+  else if (index > left_size)
+  {
+    child = node_remove(node->right, index - left_size - 1);
+    result = node_balance(node->item, node->left, child);
+  }
+  else if (node->left == NULL || node->right == NULL)
+  {
+    return node_retain(node->left ? node->left : node->right);
+  }
+  else
+  {
+    // Replace with the first item of the right subtree
+    schedule_item_t successor = *node_get(node->right, 0);
+    child = node_remove(node->right, 0);
+    result = node_balance(successor, node->left, child);
+  }
+  node_release(child);
+  return result;
+}
+
+//------------------------------------------------------------------------------
+// Versions
+//------------------------------------------------------------------------------
+
+static int ring_index(history_t *history, int offset)
+{
+  return (history->first + offset) % (history->depth + 1);
+}
+
+static history_node_t *current_root(history_t *history)
+{
+  return history->versions[ring_index(history, history->current)];
+}
+
+// Brings the flat schedule, which holds a neighbouring version, to the current
+// one: the removed items at first give way to the added ones copied out of
+// the tree, and the items after them move along
+static void history_sync(history_t *history, int first, int removed, int added)
+{
+  schedule_t *schedule = history->schedule;
+  int count = schedule->count - removed + added;
+
+  if (count + 1 >= schedule->capacity)
+  {
+    resize_schedule(schedule, count + 1);
+  }
+
+  memmove(&schedule->items[first + added],
+          &schedule->items[first + removed],
+          sizeof(schedule_item_t) * (schedule->count - first - removed));
+  node_copy(current_root(history), first, added, &schedule->items[first]);
+  schedule->count = count;
+  schedule->version++;
+  history->changed_from = first;
+}
+
+static void history_clear(history_t *history)
+{
+  for (int i = 0; i < history->count; i++)
+  {
+    node_release(history->versions[ring_index(history, i)]);
+  }
+  history->first = 0;
+  history->count = 0;
+  history->current = 0;
+}
+
+// Makes root (owned) the current version, dropping the redo branch and the
+// oldest version once the history is full. The flat view is left alone.
+static void history_push(history_t *history, history_node_t *root, history_change_t change)
+{
+  while (history->count > history->current + 1)
+  {
+    history->count--;
+    node_release(history->versions[ring_index(history, history->count)]);
+  }
+
+  if (history->count == history->depth + 1)
+  {
+    node_release(history->versions[history->first]);
+    history->first = ring_index(history, 1);
+    history->count--;
+  }
+
+  history->versions[ring_index(history, history->count)] = root;
+  history->changes[ring_index(history, history->count)] = change;
+  history->current = history->count;
+  history->count++;
+}
+
+static void history_edit(history_t *history, history_node_t *root, int first, int removed, int added)
+{
+  history_push(history, root, (history_change_t){first, removed, added});
+  history_sync(history, first, removed, added);
+}
+
+history_t *history_create(schedule_t *schedule, int depth)
+{
+  history_t *history = (history_t *)malloc(sizeof(history_t));
+  if (!history)
+    return NULL;
+
+  if (depth < 1)
+    depth = 1;
+
+  history->depth = depth;
+  history->versions = (history_node_t **)malloc(sizeof(history_node_t *) * (depth + 1));
+  history->changes = (history_change_t *)malloc(sizeof(history_change_t) * (depth + 1));
+  history->count = 0;
+  history_reset(history, schedule);
+  return history;
+}
+
+void history_destroy(history_t *history)
+{
+  if (history == NULL)
+    return;
+
+  history_clear(history);
+  free(history->versions);
+  free(history->changes);
+  free(history);
+}
+
+void history_reset(history_t *history, schedule_t *schedule)
+{
+  history_clear(history);
+  history->schedule = schedule;
+  history->versions[0] = node_build(schedule->items, schedule->count);
+  history->count = 1;
+  history->changed_from = 0;
+}
+
+bool history_set_item(history_t *history, int index, schedule_item_t item)
+{
+  history_node_t *root = current_root(history);
+  if (index < 0 || index >= node_size(root))
+    return false;
+
+  history_edit(history, node_set(root, index, item), index, 1, 1);
+  return true;
+}
+
+bool history_insert_item(history_t *history, int index, schedule_item_t item)
+{
+  history_node_t *root = current_root(history);
+  if (index < 0 || index > node_size(root))
+    return false;
+
+  history_edit(history, node_insert(root, index, item), index, 0, 1);
+  return true;
+}
+
+bool history_remove_item(history_t *history, int index)
+{
+  history_node_t *root = current_root(history);
+  if (index < 0 || index >= node_size(root))
+    return false;
+
+  history_edit(history, node_remove(root, index), index, 1, 0);
+  return true;
+}
+
+static int compare_indices(const void *a, const void *b)
+{
+  int x = *(const int *)a;
+  int y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+bool history_replace(history_t *history, const diff_t *diff)
+{
+  if (diff->count == 0)
+    return false;
+
+  int *removed = (int *)malloc(sizeof(int) * diff->count);
+  int *added = (int *)malloc(sizeof(int) * diff->count);
+  if (!removed || !added)
+  {
+    free(removed);
+    free(added);
+    return false;
+  }
+
+  int removed_count = 0;
+  int added_count = 0;
+  for (int i = 0; i < diff->count; i++)
+  {
+    if (diff->ops[i].old_index >= 0)
+      removed[removed_count++] = diff->ops[i].old_index;
+    if (diff->ops[i].new_index >= 0)
+      added[added_count++] = diff->ops[i].new_index;
+  }
+  qsort(removed, removed_count, sizeof(int), compare_indices);
+  qsort(added, added_count, sizeof(int), compare_indices);
+
+  // The items past the last one the diff names on either side are the same
+  // in both, so undo and redo only rewrite the span in between
+  int old_count = node_size(current_root(history));
+  int new_count = history->schedule->count;
+  int first = diff_first_change(diff);
+  int same = old_count - first < new_count - first ? old_count - first : new_count - first;
+  if (removed_count > 0 && old_count - 1 - removed[removed_count - 1] < same)
+    same = old_count - 1 - removed[removed_count - 1];
+  if (added_count > 0 && new_count - 1 - added[added_count - 1] < same)
+    same = new_count - 1 - added[added_count - 1];
+  history_change_t change = {first, old_count - first - same, new_count - first - same};
+
+  // Take out every item the diff deletes, moves or modifies, last first so the
+  // indices still hold. What's left is the items matched in order, already in
+  // their new order, and putting the rest in from the front at their new
+  // positions leaves everything before each one where it ends up.
+  history_node_t *root = node_retain(current_root(history));
+  for (int i = removed_count - 1; i >= 0; i--)
+  {
+    history_node_t *next = node_remove(root, removed[i]);
+    node_release(root);
+    root = next;
+  }
+  for (int i = 0; i < added_count; i++)
+  {
+    history_node_t *next = node_insert(root, added[i], history->schedule->items[added[i]]);
+    node_release(root);
+    root = next;
+  }
+  free(removed);
+  free(added);
+
+  // The schedule holds the new items already
+  history_push(history, root, change);
+  history->changed_from = first;
+  return true;
+}
+
+bool history_can_undo(history_t *history)
+{
+  return history->current > 0;
+}
+
+bool history_can_redo(history_t *history)
+{
+  return history->current < history->count - 1;
+}
+
+bool history_undo(history_t *history)
+{
+  if (!history_can_undo(history))
+    return false;
+
+  history_change_t change = history->changes[ring_index(history, history->current)];
+  history->current--;
+  history_sync(history, change.first, change.added, change.removed);
+  return true;
+}
+
+bool history_redo(history_t *history)
+{
+  if (!history_can_redo(history))
+    return false;
+
+  history->current++;
+  history_change_t change = history->changes[ring_index(history, history->current)];
+  history_sync(history, change.first, change.removed, change.added);
+  return true;
+}
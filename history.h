@@ -0,0 +1,60 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "data.h"
+#include "diff.h"
+
+// Versioned item storage for in-app editing. Versions are persistent balanced
+// trees indexed by position: an edit copies the O(log n) nodes on its path and
+// shares everything else with the version before it, so keeping a long undo
+// history is cheap and undo/redo only moves between stored roots.
+//
+// The schedule passed in stays the flat view the rest of the app reads. Each
+// version remembers which items it changed from the one before, so an edit,
+// undo or redo rewrites just those in the flat view and moves the items after
+// them along, instead of copying the whole tree out again.
+
+typedef struct history_node history_node_t;
+
+// Items a version replaced in the one before it: removed items from first on
+// made way for added ones, everything after them is the same
+typedef struct history_change
+{
+  int first;
+  int removed;
+  int added;
+} history_change_t;
+
+typedef struct history
+{
+  schedule_t *schedule;       // Flat view of the current version
+  history_node_t **versions;  // Ring of version roots, oldest first
+  history_change_t *changes;  // Ring of what each version changed
+  int depth;                  // Undo steps kept, older versions are dropped
+  int first;                  // Ring position of the oldest version
+  int count;                  // Versions stored
+  int current;                // Offset of the current version from first
+  int changed_from;           // First item the last edit, undo or redo changed
+} history_t;
+
+history_t *history_create(schedule_t *schedule, int depth);
+void history_destroy(history_t *history);
+
+// Forget all versions and start over from the given schedule's items
+void history_reset(history_t *history, schedule_t *schedule);
+
+bool history_set_item(history_t *history, int index, schedule_item_t item);
+bool history_insert_item(history_t *history, int index, schedule_item_t item);
+bool history_remove_item(history_t *history, int index);
+
+// The schedule's items were replaced from outside, by a reload, and diff says
+// how they differ from the current version. Records them as one new version,
+// so the whole change is a single undo step, in O(k log n) for k changes.
+bool history_replace(history_t *history, const diff_t *diff);
+
+bool history_can_undo(history_t *history);
+bool history_can_redo(history_t *history);
+bool history_undo(history_t *history);
+bool history_redo(history_t *history);
+
+#endif // HISTORY_H
@@ -0,0 +1,91 @@
+#include <stdlib.h>
+#include <errno.h>
+#include "idle.h"
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h" // The GLFW raylib is built with, glfwPostEmptyEvent is safe from any thread
+
+static void *idle_thread(void *arg)
+{
+  idle_timer_t *idle = (idle_timer_t *)arg;
+  pthread_mutex_lock(&idle->lock);
+  while (!idle->quit)
+  {
+    if (!idle->armed)
+    {
+      pthread_cond_wait(&idle->changed, &idle->lock);
+      continue;
+    }
+
+    // Woken early when the deadline moves, the loop picks up the new one
+    if (pthread_cond_timedwait(&idle->changed, &idle->lock, &idle->deadline) == ETIMEDOUT && idle->armed)
+    {
+      idle->armed = false;
+      pthread_mutex_unlock(&idle->lock);
+      glfwPostEmptyEvent();
+      pthread_mutex_lock(&idle->lock);
+    }
+  }
+  pthread_mutex_unlock(&idle->lock);
+  return NULL;
+}
+
+idle_timer_t *idle_create(void)
+{
+  idle_timer_t *idle = (idle_timer_t *)malloc(sizeof(idle_timer_t));
+  if (!idle)
+    return NULL;
+
+  pthread_mutex_init(&idle->lock, NULL);
+  pthread_cond_init(&idle->changed, NULL);
+  idle->armed = false;
+  idle->quit = false;
+  if (pthread_create(&idle->thread, NULL, idle_thread, idle) != 0)
+  {
+    pthread_cond_destroy(&idle->changed);
+    pthread_mutex_destroy(&idle->lock);
+    free(idle);
+    return NULL;
+  }
+  return idle;
+}
+
+void idle_destroy(idle_timer_t *idle)
+{
+  if (idle == NULL)
+    return;
+
+  pthread_mutex_lock(&idle->lock);
+  idle->quit = true;
+  pthread_cond_signal(&idle->changed);
+  pthread_mutex_unlock(&idle->lock);
+  pthread_join(idle->thread, NULL);
+
+  pthread_cond_destroy(&idle->changed);
+  pthread_mutex_destroy(&idle->lock);
+  free(idle);
+}
+
+void idle_wake_in(idle_timer_t *idle, double delay)
+{
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  if (delay > 0)
+  {
+    long nanoseconds = (long)((delay - (time_t)delay) * 1e9) + deadline.tv_nsec;
+    deadline.tv_sec += (time_t)delay + nanoseconds / 1000000000L;
+    deadline.tv_nsec = nanoseconds % 1000000000L;
+  }
+
+  pthread_mutex_lock(&idle->lock);
+  idle->deadline = deadline;
+  idle->armed = true;
+  pthread_cond_signal(&idle->changed);
+  pthread_mutex_unlock(&idle->lock);
+}
+
+double idle_now(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
@@ -0,0 +1,32 @@
+#ifndef IDLE_H
+#define IDLE_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
+
+// Wakes the main loop at a deadline while raylib waits for events. With event
+// waiting on, EndDrawing blocks until there's input, so a thread sleeps until
+// the deadline and posts an empty event to GLFW to end the wait. The loop then
+// draws a frame only on input or when something on screen is due to change.
+typedef struct idle_timer
+{
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  struct timespec deadline; // Wall clock, like the times on screen
+  bool armed;
+  bool quit;
+} idle_timer_t;
+
+idle_timer_t *idle_create(void);
+void idle_destroy(idle_timer_t *idle);
+
+// Wakes the loop delay seconds from now, replacing the last request
+void idle_wake_in(idle_timer_t *idle, double delay);
+
+// Wall clock in seconds, with the fraction time() drops, for working out
+// delays to the times on screen
+double idle_now(void);
+
+#endif // IDLE_H
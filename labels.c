@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "raylib.h"
+#include "labels.h"
+#include "scaling.h"
+
+#define CLOCK_FONT_SIZE 20
+
+label_cache_t *label_cache_create(void)
+{
+  label_cache_t *cache = (label_cache_t *)calloc(1, sizeof(label_cache_t));
+  if (!cache)
+    return NULL;
+
+  cache->text = text_cache_create();
+  cache->changed_from = -1;
+  cache->minute = -1;
+  cache->scale_epoch = scaling_get_epoch() - 1; // Measure on first update
+  return cache;
+}
+
+void label_cache_destroy(label_cache_t *cache)
+{
+  if (cache == NULL)
+    return;
+
+  text_cache_destroy(cache->text);
+  free(cache->items);
+  free(cache);
+}
+
+static float item_completion(const schedule_item_t *item, time_t now)
+{
+  if (now < item->start)
+    return 0.0f;
+  if (now > item->end)
+    return 100.0f;
+
+  float duration = item->end - item->start;
+  float elapsed = now - item->start;
+  return (elapsed / duration) * 100.0f;
+}
+
+// First second after now at which the percentage item_completion gives for
+// the item moves, so an idle frame knows when to wake. The status flags move
+// with the cache's next_status instead.
+static time_t item_next_change(const schedule_item_t *item, int percent, time_t now)
+{
+  if (now > item->end || percent >= 100)
+    return 0;
+
+  time_t duration = item->end - item->start;
+  return item->start + ((percent + 1) * duration + 99) / 100;
+}
+
+void label_cache_update(label_cache_t *cache, const schedule_t *schedule, time_t now)
+{
+  bool items_changed = schedule != cache->schedule || schedule->version != cache->version;
+  bool scale_changed = scaling_get_epoch() != cache->scale_epoch;
+  bool minute_changed = now / 60 != cache->minute;
+
+  if (items_changed)
+  {
+    if (schedule->count > cache->capacity)
+    {
+      cache->capacity = schedule->count;
+      cache->items = (item_labels_t *)realloc(cache->items, sizeof(item_labels_t) * cache->capacity);
+    }
+    // Items before the first change still have the text they had
+    int first = schedule == cache->schedule && cache->changed_from >= 0 ? cache->changed_from : 0;
+    if (first > cache->count)
+      first = cache->count;
+    cache->count = schedule->count;
+    cache->schedule = schedule;
+    cache->version = schedule->version;
+    cache->changed_from = -1;
+
+    for (int i = first; i < cache->count; i++)
+    {
+      const schedule_item_t *item = &schedule->items[i];
+      format_duration_12hr(item->start, item->end, cache->items[i].duration, sizeof(cache->items[i].duration));
+      cache->items[i].percent = -1;
+    }
+  }
+
+  if (scale_changed)
+  {
+    cache->scale_epoch = scaling_get_epoch();
+    cache->current_width = text_cache_width(cache->text, "Current", scaling_apply_y(LABEL_FONT_SIZE));
+    for (int i = 0; i < cache->count; i++)
+    {
+      cache->items[i].percent = -1; // Re-measured on next access
+    }
+  }
+
+  // An item is current from its start through its end second and past after.
+  // The minute check catches the clock being set back.
+  if (items_changed || minute_changed || (cache->next_status > 0 && now >= cache->next_status))
+  {
+    cache->next_status = 0;
+    for (int i = 0; i < cache->count; i++)
+    {
+      const schedule_item_t *item = &schedule->items[i];
+      cache->items[i].current = now >= item->start && now <= item->end;
+      cache->items[i].past = now > item->end;
+
+      time_t next = now < item->start ? item->start : now <= item->end ? item->end + 1 : 0;
+      if (next > 0 && (cache->next_status == 0 || next < cache->next_status))
+        cache->next_status = next;
+    }
+  }
+
+  if (scale_changed || minute_changed)
+  {
+    cache->minute = now / 60;
+    cache->clock = format_time_12hr(now);
+    cache->clock_width = text_cache_width(cache->text, cache->clock, scaling_apply_y(CLOCK_FONT_SIZE));
+  }
+}
+
+void label_cache_patch(label_cache_t *cache, int first)
+{
+  if (cache->changed_from < 0 || first < cache->changed_from)
+    cache->changed_from = first;
+}
+
+const item_labels_t *label_cache_get(label_cache_t *cache, int index, time_t now)
+{
+  item_labels_t *labels = &cache->items[index];
+  labels->completion = item_completion(&cache->schedule->items[index], now);
+  int percent = (int)labels->completion;
+  if (percent != labels->percent)
+  {
+    snprintf(labels->percentage, sizeof(labels->percentage), "%d%%", percent);
+    labels->percentage_width = text_cache_width(cache->text, labels->percentage, scaling_apply_y(LABEL_FONT_SIZE));
+    labels->percent = percent;
+  }
+  labels->next_change = item_next_change(&cache->schedule->items[index], percent, now);
+  return labels;
+}
@@ -0,0 +1,61 @@
+#ifndef LABELS_H
+#define LABELS_H
+
+#include "data.h"
+#include "textcache.h"
+
+#define LABEL_FONT_SIZE 13 // Unscaled size of the percentage and marker text
+
+// Everything drawn for an item that isn't geometry, formatted and measured
+typedef struct item_labels
+{
+  char duration[FORMAT_DURATION_SIZE];
+  char percentage[8];
+  int percentage_width;
+  float completion; // 0 to 100 as of the last label_cache_get
+  int percent;      // Value percentage was formatted from, -1 when stale
+  time_t next_change; // When percent next moves, 0 if never
+  bool current;
+  bool past;
+} item_labels_t;
+
+// Labels for every item of a schedule, redone only when what they depend on
+// moves: item text on the schedule version, from the first changed item when
+// label_cache_patch says which, current/past state when the clock reaches the
+// next item start or end, the header clock on the minute and widths on the
+// scale epoch. Percentages are refreshed per item when their integer value
+// changes.
+typedef struct label_cache
+{
+  item_labels_t *items;
+  int count;
+  int capacity;
+
+  const schedule_t *schedule; // Schedule the labels were built for
+  unsigned int version;       // Its version at the time
+  int changed_from;           // First item changed since, -1 when not known
+  time_t next_status;         // When an item next starts or ends, 0 if never
+  long minute;                // Clock minute the clock label is for
+  unsigned int scale_epoch;   // Scale the widths were measured at
+
+  text_cache_t *text; // Measured and fitted text, titles are fitted from it too
+  int current_width;  // Width of the "Current" marker text
+  const char *clock; // Header clock label
+  int clock_width;
+} label_cache_t;
+
+label_cache_t *label_cache_create(void);
+void label_cache_destroy(label_cache_t *cache);
+
+// Brings the cache in line with the schedule, clock and scale. Cheap when
+// nothing changed, call once per frame before drawing.
+void label_cache_update(label_cache_t *cache, const schedule_t *schedule, time_t now);
+
+// Items from first on changed in the schedule the cache was built for, the
+// ones before it keep their text. Call along with every change to it.
+void label_cache_patch(label_cache_t *cache, int first);
+
+// Labels of one item, with the percentage refreshed for now
+const item_labels_t *label_cache_get(label_cache_t *cache, int index, time_t now);
+
+#endif // LABELS_H
@@ -0,0 +1,280 @@
+#include <stdlib.h>
+#include <string.h>
+#include "layout.h"
+#include "scaling.h"
+
+static void layout_on_scale(float scale_x, float scale_y, void *user_data)
+{
+  layout_tree_t *tree = (layout_tree_t *)user_data;
+
+  // Gaps and padding are scaled, so every container is affected
+  tree->dirty = true;
+  for (int i = 0; i < tree->count; i++)
+  {
+    tree->nodes[i].dirty = true;
+    tree->nodes[i].subtree_dirty = true;
+  }
+}
+
+layout_tree_t *layout_create(void)
+{
+  layout_tree_t *tree = (layout_tree_t *)calloc(1, sizeof(layout_tree_t));
+  if (!tree)
+    return NULL;
+
+  scaling_add_listener(layout_on_scale, tree);
+  return tree;
+}
+
+void layout_destroy(layout_tree_t *tree)
+{
+  if (tree == NULL)
+    return;
+
+  free(tree->nodes);
+  free(tree->scratch);
+  free(tree);
+}
+
+void layout_clear(layout_tree_t *tree)
+{
+  tree->count = 0;
+  tree->dirty = false;
+}
+
+//------------------------------------------------------------------------------
+// Building
+//------------------------------------------------------------------------------
+
+int layout_add(layout_tree_t *tree, int parent)
+{
+  if (tree->count == tree->capacity)
+  {
+    int capacity = tree->capacity ? tree->capacity * 2 : 64;
+    layout_node_t *nodes = (layout_node_t *)realloc(tree->nodes, sizeof(layout_node_t) * capacity);
+    if (!nodes)
+      return -1;
+    tree->nodes = nodes;
+    tree->capacity = capacity;
+  }
+
+  int id = tree->count++;
+  layout_node_t *node = &tree->nodes[id];
+  memset(node, 0, sizeof(*node));
+  node->direction = fbox_DIRECTION_COLUMN;
+  node->parent = parent;
+  node->first_child = -1;
+  node->last_child = -1;
+  node->next_sibling = -1;
+  node->dirty = true;
+  tree->dirty = true;
+
+  if (parent >= 0)
+  {
+    layout_node_t *p = &tree->nodes[parent];
+    if (p->last_child >= 0)
+      tree->nodes[p->last_child].next_sibling = id;
+    else
+      p->first_child = id;
+    p->last_child = id;
+    p->child_count++;
+    layout_mark_dirty(tree, parent);
+  }
+  return id;
+}
+
+layout_node_t *layout_get(layout_tree_t *tree, int id)
+{
+  return &tree->nodes[id];
+}
+
+bool layout_set_flex_weights(layout_tree_t *tree, int id, const float *weights, int count)
+{
+  layout_node_t *node = &tree->nodes[id];
+  node->flex_count = count < FBOX_MAX_WEIGHTS ? count : FBOX_MAX_WEIGHTS;
+  memcpy(node->flex_weights, weights, sizeof(float) * node->flex_count);
+  layout_mark_dirty(tree, id);
+  if (count <= FBOX_MAX_WEIGHTS)
+    return true;
+
+  TraceLog(LOG_WARNING, "Layout node %d has %d flex weights, only the first %d are used", id, count, FBOX_MAX_WEIGHTS);
+  return false;
+}
+
+//------------------------------------------------------------------------------
+// Invalidation
+//------------------------------------------------------------------------------
+
+void layout_mark_dirty(layout_tree_t *tree, int id)
+{
+  tree->nodes[id].dirty = true;
+  tree->dirty = true;
+
+  // Ancestors only need to know to look further down, stop at the first one
+  // that already does
+  for (int p = tree->nodes[id].parent; p >= 0 && !tree->nodes[p].subtree_dirty; p = tree->nodes[p].parent)
+  {
+    tree->nodes[p].subtree_dirty = true;
+  }
+}
+
+void layout_set_size(layout_tree_t *tree, int id, Vector2 size)
+{
+  layout_node_t *node = &tree->nodes[id];
+  if (node->size.x == size.x && node->size.y == size.y)
+    return;
+
+  node->size = size;
+  if (node->parent >= 0)
+    layout_mark_dirty(tree, node->parent);
+}
+
+void layout_set_rect(layout_tree_t *tree, int id, Rectangle rect)
+{
+  layout_node_t *node = &tree->nodes[id];
+  if (memcmp(&node->rect, &rect, sizeof(rect)) == 0)
+    return;
+
+  node->rect = rect;
+  layout_mark_dirty(tree, id);
+}
+
+void layout_set_hidden(layout_tree_t *tree, int id, bool hidden)
+{
+  layout_node_t *node = &tree->nodes[id];
+  if (node->hidden == hidden)
+    return;
+
+  node->hidden = hidden;
+  if (node->parent >= 0)
+    layout_mark_dirty(tree, node->parent);
+}
+
+//------------------------------------------------------------------------------
+// Layout
+//------------------------------------------------------------------------------
+
+static void layout_arrange(layout_tree_t *tree, int id)
+{
+  layout_node_t *node = &tree->nodes[id];
+  if (node->child_count > tree->scratch_capacity)
+  {
+    tree->scratch = (fbox_rect_t *)realloc(tree->scratch, sizeof(fbox_rect_t) * node->child_count);
+    tree->scratch_capacity = node->child_count;
+  }
+
+  int visible = 0;
+  for (int c = node->first_child; c >= 0; c = tree->nodes[c].next_sibling)
+  {
+    if (!tree->nodes[c].hidden)
+      visible++;
+  }
+
+  fbox_context_t ctx = fbox_create(node->rect, node->direction, NULL);
+  fbox_set_main_align(&ctx, node->main_align);
+  fbox_set_cross_align(&ctx, node->cross_align);
+  fbox_set_gap(&ctx, node->gap);
+  fbox_set_padding_x(&ctx, node->padding_x);
+  fbox_set_padding_y(&ctx, node->padding_y);
+  fbox_set_size_mode(&ctx, node->size_mode);
+  fbox_set_expected_items(&ctx, visible);
+  if (node->flex_count > 0 && !fbox_set_flex_weights(&ctx, node->flex_weights))
+    TraceLog(LOG_WARNING, "Layout node %d weights %d items, past the %d flex weights kept", id, visible, FBOX_MAX_WEIGHTS);
+  fbox_set_storage(&ctx, tree->scratch, tree->scratch_capacity);
+
+  for (int c = node->first_child; c >= 0; c = tree->nodes[c].next_sibling)
+  {
+    if (!tree->nodes[c].hidden)
+      fbox_measure(&ctx, tree->nodes[c].size);
+  }
+  fbox_arrange(&ctx);
+  node->content = (Vector2){ctx.content_width, ctx.content_height};
+
+  // Children that moved or resized have to place their own children again
+  int i = 0;
+  for (int c = node->first_child; c >= 0; c = tree->nodes[c].next_sibling)
+  {
+    layout_node_t *child = &tree->nodes[c];
+    if (child->hidden)
+      continue;
+    Rectangle rect = fbox_to_rectangle(tree->scratch[i++]);
+    if (memcmp(&child->rect, &rect, sizeof(rect)) != 0)
+    {
+      child->rect = rect;
+      child->dirty = true;
+    }
+  }
+}
+
+static void layout_visit(layout_tree_t *tree, int id)
+{
+  layout_node_t *node = &tree->nodes[id];
+  if (node->dirty && node->child_count > 0)
+    layout_arrange(tree, id);
+
+  node = &tree->nodes[id];
+  bool descend = node->dirty || node->subtree_dirty;
+  node->dirty = false;
+  node->subtree_dirty = false;
+  if (!descend)
+    return;
+
+  for (int c = node->first_child; c >= 0; c = tree->nodes[c].next_sibling)
+  {
+    if (!tree->nodes[c].hidden && (tree->nodes[c].dirty || tree->nodes[c].subtree_dirty))
+      layout_visit(tree, c);
+  }
+}
+
+bool layout_update(layout_tree_t *tree)
+{
+  if (!tree->dirty)
+    return false;
+
+  for (int i = 0; i < tree->count; i++)
+  {
+    layout_node_t *node = &tree->nodes[i];
+    if (node->parent < 0 && (node->dirty || node->subtree_dirty))
+      layout_visit(tree, i);
+  }
+  tree->dirty = false;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Templates
+//------------------------------------------------------------------------------
+
+bool layout_template_update(layout_template_t *template, layout_tree_t *tree, int root, Vector2 size)
+{
+  if (layout_template_matches(template, size) && template->root == root && template->scale_epoch == scaling_get_epoch())
+    return false;
+
+  int count = tree->count - root;
+  if (count > template->capacity)
+  {
+    template->rects = (Rectangle *)realloc(template->rects, sizeof(Rectangle) * count);
+    template->capacity = count;
+  }
+
+  layout_set_rect(tree, root, (Rectangle){0, 0, size.x, size.y});
+  layout_update(tree);
+  for (int i = 0; i < count; i++)
+  {
+    template->rects[i] = tree->nodes[root + i].rect;
+  }
+
+  template->root = root;
+  template->count = count;
+  template->size = size;
+  template->scale_epoch = scaling_get_epoch();
+  return true;
+}
+
+void layout_template_free(layout_template_t *template)
+{
+  free(template->rects);
+  template->rects = NULL;
+  template->count = 0;
+  template->capacity = 0;
+}
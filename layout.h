@@ -0,0 +1,109 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <stdbool.h>
+#include "raylib.h"
+#include "scrollable.h"
+#include "flexbox.h"
+
+// A node is a box placed by its parent and, when it has children, an fbox
+// container placing them. Gap and padding are unscaled like the fbox setters,
+// sizes are in pixels.
+typedef struct layout_node
+{
+  fbox_direction_t direction;
+  fbox_align_t main_align;
+  fbox_align_t cross_align;
+  fbox_size_mode_t size_mode;
+  float gap;
+  float padding_x;
+  float padding_y;
+  float flex_weights[FBOX_MAX_WEIGHTS];
+  int flex_count;
+
+  Vector2 size;    // Size asked of the parent
+  Rectangle rect;  // Where the parent placed it
+  Vector2 content; // Content size of the children, as fbox reports it
+  bool hidden;     // Left out of the parent's layout
+
+  int parent;
+  int first_child;
+  int last_child;
+  int next_sibling;
+  int child_count;
+
+  bool dirty;         // Children need arranging again
+  bool subtree_dirty; // Some descendant is dirty
+} layout_node_t;
+
+// Retained layout, only the parts marked dirty are arranged again. Sizes,
+// rectangles and visibility changes mark what they affect, scale changes mark
+// everything.
+typedef struct layout_tree
+{
+  layout_node_t *nodes;
+  int count;
+  int capacity;
+  fbox_rect_t *scratch; // Storage handed to fbox while arranging one node
+  int scratch_capacity;
+  bool dirty; // Any node is dirty, so idle updates return straight away
+} layout_tree_t;
+
+layout_tree_t *layout_create(void);
+void layout_destroy(layout_tree_t *tree);
+void layout_clear(layout_tree_t *tree); // Drop all nodes, keeping the memory
+
+// Appends a node under parent, or a root when parent is -1. Configure it
+// through layout_get before the next layout_update.
+int layout_add(layout_tree_t *tree, int parent);
+layout_node_t *layout_get(layout_tree_t *tree, int id);
+// Keeps at most FBOX_MAX_WEIGHTS, warning and returning false past that
+bool layout_set_flex_weights(layout_tree_t *tree, int id, const float *weights, int count);
+
+// Each of these is a no-op when nothing changes
+void layout_set_size(layout_tree_t *tree, int id, Vector2 size);
+void layout_set_rect(layout_tree_t *tree, int id, Rectangle rect); // For roots
+void layout_set_hidden(layout_tree_t *tree, int id, bool hidden);
+void layout_mark_dirty(layout_tree_t *tree, int id);
+
+// Arranges the dirty parts of the tree. Returns false, having done nothing,
+// when no node was dirty.
+bool layout_update(layout_tree_t *tree);
+
+static inline Rectangle layout_rect(const layout_tree_t *tree, int id)
+{
+  return tree->nodes[id].rect;
+}
+
+// Relative rectangles of a subtree laid out once for one size and scale, to be
+// stamped onto any number of boxes of that size with just a translation. The
+// subtree is the root and every node added to the tree after it.
+typedef struct layout_template
+{
+  Rectangle *rects; // Per node, relative to the root's top left
+  int root;
+  int count;
+  int capacity;
+  Vector2 size;             // Size the rects were laid out for
+  unsigned int scale_epoch; // And the scale
+} layout_template_t;
+
+// Lays the subtree out again when size or scale differ from what the
+// template holds. Returns whether it did.
+bool layout_template_update(layout_template_t *template, layout_tree_t *tree, int root, Vector2 size);
+void layout_template_free(layout_template_t *template);
+
+static inline bool layout_template_matches(const layout_template_t *template, Vector2 size)
+{
+  return template->count > 0 && template->size.x == size.x && template->size.y == size.y;
+}
+
+static inline Rectangle layout_stamp(const layout_template_t *template, int id, Vector2 origin)
+{
+  Rectangle rect = template->rects[id - template->root];
+  rect.x += origin.x;
+  rect.y += origin.y;
+  return rect;
+}
+
+#endif // LAYOUT_H
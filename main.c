@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
+#include <math.h>
 
 #include "raylib.h"
 #include "data.h"
@@ -9,8 +10,21 @@
 #include "flexbox.h"
 #include "scaling.h"
 #include "parser.h"
+#include "calendar.h"
+#include "tzcache.h"
+#include "history.h"
+#include "search.h"
+#include "reminder.h"
+#include "labels.h"
+#include "layout.h"
+#include "offsets.h"
+#include "wall.h"
+#include "idle.h"
+#include "filewatch.h"
+#include "tilecache.h"
+#include "cardbatch.h"
 
-#define VERSION "0.8.0"
+#define VERSION "0.9.0"
 
 #ifdef _WIN32
 #define _CRT_SECURE_NO_WARNINGS
@@ -19,6 +33,16 @@
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 600
 
+#define HISTORY_DEPTH 256 // Undo steps kept per day
+#define EDIT_STEP (5 * 60)      // Seconds ctrl+up and ctrl+down move the selected item by
+#define RELOAD_INTERVAL 1.0 // Seconds between checks for schedule file changes, without a file watch
+#define PREFETCH_LEAD (30 * 60) // Seconds before midnight to start reading tomorrow
+#define PREFETCH_POLL 0.05      // Seconds between looks at rooms being read in the background
+#define REMINDER_LEAD (5 * 60)  // Seconds of warning before an item starts or ends
+#define REMINDER_SHOWN 10.0     // Seconds a reminder stays in the header
+#define IDLE_LONGEST 60.0       // Most seconds a frame waits for, should a deadline be missed
+#define IDLE_SLACK 0.02         // Past a deadline, time() reads a coarse clock that lags by a few ms
+
 #define LIGHT_BLUE \
   (Color) { 235, 240, 255, 255 }
 #define LIGHT_PURPLE \
@@ -26,253 +50,1203 @@
 #define LIGHT_GRAY \
   (Color) { 220, 220, 220, 255 }
 
-float get_item_completion(schedule_item_t *item)
+// Retained layout of the header, title and clock either side
+typedef struct header_view
 {
-  time_t now = time(NULL);
-  if (now < item->start)
-    return 0.0f;
-  if (now > item->end)
-    return 100.0f;
+  layout_tree_t *layout;
+  int root;
+  int title;
+  int clock;
+} header_view_t;
 
-  float duration = item->end - item->start;
-  float elapsed = now - item->start;
-  return (elapsed / duration) * 100.0f;
-}
+// Layout nodes of one card in the schedule list
+typedef struct card_view
+{
+  int card;
+  int info;
+  int title;
+  int time;
+  int progress;
+  int percentage;
+  int marker;
+} card_view_t;
+
+#define CARD_TEMPLATES 4 // Card sizes whose layout is kept at once
 
-static char *format_percentage(float percentage)
+// Layout of the visible part of the schedule list. Where each card goes comes
+// from an offset index of card heights, so finding the cards on screen, or any
+// card's position, is O(log n). What goes inside a card only depends on its
+// size, so one card is laid out per size and stamped onto every card sharing
+// it. Widths that vary per card (the percentage) are end aligned on stamping.
+typedef struct schedule_view
 {
-  char *buffer = malloc(10);
-  sprintf(buffer, "%d%%", (int)percentage);
-  return buffer;
+  layout_tree_t *layout; // The one card the templates are laid out from
+  card_view_t card;
+  layout_template_t templates[CARD_TEMPLATES];
+  int next_template;        // Replaced when a new size turns up
+  unsigned int scale_epoch; // Scale the card was built at
+
+  offset_index_t *offsets; // Height plus gap of every card shown
+  bool offsets_stale;      // Cards shown changed, see schedule_view_invalidate
+  int changed_from;        // First card showing another item, see schedule_view_patch
+  int scroll_to;           // Card to bring to the top next frame, or -1
+
+  int hover;    // Card under the mouse as of the last frame drawn, or -1
+  int selected; // Item picked with a click, or -1
+  time_t next_change; // When a card on screen next looks different, 0 if never
+
+  tile_cache_t *tiles;            // The list as drawn, see draw_schedule
+  card_batch_t *batch;            // Card geometry the tiles are drawn from
+  unsigned int *states;           // card_state of each card this frame
+  unsigned int *drawn;            // card_state each card is drawn in the tiles with, 0 if not
+  int states_capacity;            // Of both, which share an allocation
+  unsigned int states_generation; // Tile generation drawn holds for
+} schedule_view_t;
+
+#define CARD_HEIGHT 100
+#define CARD_GAP 14
+#define LIST_PADDING 14
+
+static void header_view_init(header_view_t *view)
+{
+  view->layout = layout_create();
+  view->root = layout_add(view->layout, -1);
+  layout_node_t *root = layout_get(view->layout, view->root);
+  root->direction = fbox_DIRECTION_ROW;
+  root->main_align = fbox_ALIGN_SPACE_BETWEEN;
+  root->cross_align = fbox_ALIGN_CENTER;
+  root->padding_x = 14;
+  root->padding_y = 14;
+
+  view->title = layout_add(view->layout, view->root);
+  view->clock = layout_add(view->layout, view->root);
 }
 
-void draw_header()
+void draw_header(header_view_t *view, label_cache_t *labels, int date, const char *search, const char *notice)
 {
-  fbox_context_t header_fbox = fbox_create((Rectangle){0, 0, GetScreenWidth(), scaling_apply_y(50)},
-                                           fbox_DIRECTION_ROW,
-                                           NULL);
-  fbox_set_main_align(&header_fbox, fbox_ALIGN_SPACE_BETWEEN);
-  fbox_set_cross_align(&header_fbox, fbox_ALIGN_CENTER);
-  fbox_set_expected_items(&header_fbox, 2);
-  fbox_set_padding(&header_fbox, 14);
-  fbox_set_size_mode(&header_fbox, fbox_SIZE_FIXED);
+  // Show which day is on screen once the user navigates away from today, or
+  // the search being typed
+  char searchText[SEARCH_MAX_QUERY + 16];
+  char dateText[FORMAT_DATE_SIZE];
+  const char *title = date == date_today() ? "Schedule" : format_date(make_date_time(date, 12, 0), dateText, sizeof(dateText));
+  if (search)
+  {
+    snprintf(searchText, sizeof(searchText), "Search: %s_", search);
+    title = searchText;
+  }
+  else if (notice)
+  {
+    title = notice;
+  }
 
-  int titleWidth = MeasureText("Schedule", scaling_apply_y(20));
-  Rectangle titleRect = fbox_next(&header_fbox, (Vector2){titleWidth, scaling_apply_y(20)});
-  DrawText("Schedule", titleRect.x, titleRect.y, scaling_apply_y(20), BLACK);
+  layout_tree_t *layout = view->layout;
+  layout_set_rect(layout, view->root, (Rectangle){0, 0, GetScreenWidth(), scaling_apply_y(50)});
+  layout_set_size(layout, view->title, (Vector2){text_cache_width(labels->text, title, scaling_apply_y(20)), scaling_apply_y(20)});
+  layout_set_size(layout, view->clock, (Vector2){labels->clock_width, scaling_apply_y(20)});
+  layout_update(layout);
 
-  char *timeText = format_time_12hr(time(NULL));
-  int timeWidth = MeasureText(timeText, scaling_apply_y(20));
-  Rectangle timeRect = fbox_next(&header_fbox, (Vector2){timeWidth, scaling_apply_y(20)});
-  DrawText(timeText, timeRect.x, timeRect.y, scaling_apply_y(20), BLACK);
-  free_formatted_time(timeText);
+  Rectangle titleRect = layout_rect(layout, view->title);
+  Rectangle timeRect = layout_rect(layout, view->clock);
+  DrawText(title, titleRect.x, titleRect.y, scaling_apply_y(20), BLACK);
+  DrawText(labels->clock, timeRect.x, timeRect.y, scaling_apply_y(20), BLACK);
 
+  Rectangle bounds = layout_rect(layout, view->root);
   DrawLine(0,
-           header_fbox.bounds.y + header_fbox.bounds.height,
+           bounds.y + bounds.height,
            GetScreenWidth(),
-           header_fbox.bounds.y + header_fbox.bounds.height,
+           bounds.y + bounds.height,
            (Color){GRAY.r, GRAY.g, GRAY.b, 100});
-  fbox_destroy(&header_fbox);
-}
-
-void draw_schedule(schedule_t *schedule, scrollable_t *scrollable)
-{
-  schedule_iterator_t *iterator = create_iterator(schedule);
-  schedule_item_t *item = get_current_item(iterator);
-
-  fbox_context_t items_fbox = fbox_create(
-      (Rectangle){0, scaling_apply_y(50), scrollable->bounds.width, scrollable->bounds.height},
-      fbox_DIRECTION_COLUMN,
-      scrollable);
-  fbox_set_main_align(&items_fbox, fbox_ALIGN_START);
-  fbox_set_cross_align(&items_fbox, fbox_ALIGN_START);
-  fbox_set_gap(&items_fbox, 14);
-  fbox_set_padding(&items_fbox, 14);
-  fbox_set_expected_items(&items_fbox, schedule->count);
-  fbox_set_size_mode(&items_fbox, fbox_SIZE_STRETCH);
-
-  while (item != NULL)
-  {
-    Vector2 size = (Vector2){
-        0,
-        scaling_apply_y(100)};
-
-    bool is_current = is_item_current(item);
-    bool is_past = is_item_past(item);
-
-    Rectangle itemRect = fbox_next(&items_fbox, size);
-    Color color = item->type == SCHEDULE_ITEM_TYPE_BREAK ? LIGHT_BLUE : LIGHT_PURPLE;
-    DrawRectangleRec(itemRect, color);
-    Color lineColor = is_current ? PURPLE : is_past ? LIGHT_GRAY
-                                                    : DARKGRAY;
-    DrawRectangleRoundedLinesEx(itemRect, 0.1f, 8, 3, lineColor);
-
-    float completion = get_item_completion(item);
-    Rectangle progressRect = itemRect;
-    progressRect.width = (progressRect.width * completion) / 100.0f;
-    DrawRectangleRounded(progressRect, 0.1f, 8, (Color){lineColor.r, lineColor.g, lineColor.b, 40});
-
-    fbox_context_t item_content_fbox = fbox_create_nested(&items_fbox, itemRect);
-    fbox_set_direction(&item_content_fbox, fbox_DIRECTION_ROW);
-    fbox_set_main_align(&item_content_fbox, fbox_ALIGN_SPACE_BETWEEN);
-    fbox_set_padding(&item_content_fbox, 10);
-    fbox_set_expected_items(&item_content_fbox, 2);
-    fbox_set_size_mode(&item_content_fbox, fbox_SIZE_STRETCH);
-    fbox_set_flex_weights(&item_content_fbox, (float[]){0.7f, 0.3f});
-
-    { // Title and time range
-      Rectangle item_info_rect = fbox_next(&item_content_fbox, (Vector2){0, itemRect.height});
-      fbox_context_t item_info = fbox_create_nested(&item_content_fbox, item_info_rect);
-      fbox_set_direction(&item_info, fbox_DIRECTION_COLUMN);
-      fbox_set_gap(&item_info, 5);
-      fbox_set_expected_items(&item_info, 2);
-
-      Rectangle titleRect = fbox_next(&item_info, (Vector2){0, scaling_apply_y(20)});
-      DrawText(item->title,
-               titleRect.x,
-               titleRect.y,
-               scaling_apply_y(20),
-               BLACK);
-
-      Rectangle timeRect = fbox_next(&item_info, (Vector2){0, scaling_apply_y(20)});
-      char *duration_text = format_duration_12hr(item->start, item->end);
-
-      DrawText(duration_text,
-               timeRect.x,
-               timeRect.y,
-               scaling_apply_y(20),
-               BLACK);
-      free_formatted_duration(duration_text);
-
-      item = get_next_item(iterator);
-      fbox_destroy(&item_info);
+}
+
+// The cards shown changed, their heights are gathered again before drawing
+static void schedule_view_invalidate(schedule_view_t *view)
+{
+  view->offsets_stale = true;
+}
+
+// The items behind cards first on changed, after an edit or a reload, and the
+// cards before it are as they were. Those stay in the tiles and only the rest
+// of the list is drawn again.
+static void schedule_view_patch(schedule_view_t *view, int first)
+{
+  if (view->changed_from < 0 || first < view->changed_from)
+    view->changed_from = first;
+}
+
+static void schedule_view_scroll_to(schedule_view_t *view, int position)
+{
+  view->scroll_to = position;
+}
+
+// Card at a point on screen, or -1. The point is moved into the list's content
+// coordinates, undoing the scroll, and looked up in the offset index, so a hit
+// is O(log n) however long the list. Offsets are in scaled pixels already.
+static int schedule_view_hit(const schedule_view_t *view, const scrollable_t *scrollable, Vector2 point)
+{
+  if (view->offsets->count == 0 || !scrollable_contains(scrollable, point))
+    return -1;
+
+  float padding_x = scaling_apply_x(LIST_PADDING);
+  float top = scaling_apply_y(50) + scaling_apply_y(LIST_PADDING);
+  float gap = scaling_apply_y(CARD_GAP);
+  if (point.x < padding_x || point.x > scrollable->bounds.width - padding_x)
+    return -1;
+
+  float y = point.y + scrollable->scroll_offset - top;
+  if (y < 0)
+    return -1;
+  int card = offsets_find(view->offsets, y);
+  if (y - offsets_y(view->offsets, card) >= offsets_height(view->offsets, card) - gap)
+    return -1; // In the gap below it, or past the last card
+  return card;
+}
+
+static void schedule_view_build(schedule_view_t *view, const label_cache_t *labels)
+{
+  layout_tree_t *layout = view->layout;
+  card_view_t *card = &view->card;
+  layout_clear(layout);
+
+  card->card = layout_add(layout, -1);
+  layout_node_t *node = layout_get(layout, card->card);
+  node->direction = fbox_DIRECTION_ROW;
+  node->main_align = fbox_ALIGN_SPACE_BETWEEN;
+  node->padding_x = 10;
+  node->padding_y = 10;
+  node->size_mode = fbox_SIZE_STRETCH;
+  layout_set_flex_weights(layout, card->card, (float[]){0.7f, 0.3f}, 2);
+
+  // Title and time range
+  card->info = layout_add(layout, card->card);
+  node = layout_get(layout, card->info);
+  node->gap = 5;
+  card->title = layout_add(layout, card->info);
+  layout_get(layout, card->title)->size = (Vector2){0, scaling_apply_y(20)};
+  card->time = layout_add(layout, card->info);
+  layout_get(layout, card->time)->size = (Vector2){0, scaling_apply_y(20)};
+
+  // Percentage progress and current marker, both end aligned
+  card->progress = layout_add(layout, card->card);
+  node = layout_get(layout, card->progress);
+  node->cross_align = fbox_ALIGN_END;
+  card->percentage = layout_add(layout, card->progress);
+  layout_get(layout, card->percentage)->size = (Vector2){0, scaling_apply_y(20)};
+  card->marker = layout_add(layout, card->progress);
+  layout_get(layout, card->marker)->size = (Vector2){labels->current_width + 10, scaling_apply_y(20)};
+
+  view->scale_epoch = scaling_get_epoch();
+}
+
+// Template for cards of the given size, laid out when first asked for
+static const layout_template_t *schedule_view_template(schedule_view_t *view, Vector2 size)
+{
+  layout_template_t *template = NULL;
+  for (int i = 0; i < CARD_TEMPLATES && !template; i++)
+  {
+    if (layout_template_matches(&view->templates[i], size))
+      template = &view->templates[i];
+  }
+  if (!template)
+  {
+    template = &view->templates[view->next_template];
+    view->next_template = (view->next_template + 1) % CARD_TEMPLATES;
+  }
+
+  layout_template_update(template, view->layout, view->card.card, size);
+  return template;
+}
+
+// Packs everything that changes how a card looks, short of the schedule
+// itself, into one word. Never 0, which marks a card not in the tiles yet.
+static unsigned int card_state(const item_labels_t *item_labels, int bar, bool hover, bool selected)
+{
+  return 1u | (unsigned int)item_labels->current << 1 | (unsigned int)item_labels->past << 2 |
+         (unsigned int)hover << 3 | (unsigned int)selected << 4 |
+         (unsigned int)item_labels->percent << 5 | (unsigned int)bar << 12;
+}
+
+// When the card next looks different with nobody touching it, from its labels
+// or its progress bar growing a pixel, which on wide cards with short items
+// comes sooner. 0 if never.
+static time_t card_next_change(const schedule_item_t *item, const item_labels_t *item_labels, int bar, float width, time_t now)
+{
+  time_t change = item_labels->next_change;
+  if (item_labels->current && width >= 1)
+  {
+    time_t duration = item->end - item->start;
+    time_t pixels = (time_t)width;
+    time_t next_pixel = item->start + ((bar + 1) * duration + pixels - 1) / pixels;
+    if (next_pixel > now && next_pixel < change)
+      change = next_pixel;
+  }
+  return change;
+}
+
+static mesh_color_t to_mesh_color(Color color)
+{
+  return (mesh_color_t){color.r, color.g, color.b, color.a};
+}
+
+static mesh_rect_t to_mesh_rect(Rectangle rect)
+{
+  return (mesh_rect_t){rect.x, rect.y, rect.width, rect.height};
+}
+
+// Geometry of a card, everything but its text
+static void card_shape(const layout_template_t *template, const card_view_t *card, const schedule_item_t *item,
+                       const item_labels_t *item_labels, Vector2 origin, bool hover, bool selected, mesh_card_t *shape)
+{
+  Rectangle itemRect = layout_stamp(template, card->card, origin);
+  Color lineColor = item_labels->current ? PURPLE : item_labels->past ? LIGHT_GRAY
+                                                                      : DARKGRAY;
+  shape->rect = to_mesh_rect(itemRect);
+  shape->roundness = 0.1f;
+  shape->fill = to_mesh_color(item->type == SCHEDULE_ITEM_TYPE_BREAK ? LIGHT_BLUE : LIGHT_PURPLE);
+  shape->shade = hover ? (mesh_color_t){0, 0, 0, 12} : (mesh_color_t){0};
+  shape->line_width = selected ? 5 : 3;
+  shape->line = to_mesh_color(selected ? BLUE : lineColor);
+  shape->progress = (itemRect.width * item_labels->completion) / 100.0f;
+  shape->progress_color = (mesh_color_t){lineColor.r, lineColor.g, lineColor.b, 40};
+
+  shape->marker = (mesh_rect_t){0};
+  if (item_labels->current)
+  {
+    shape->marker = to_mesh_rect(layout_stamp(template, card->marker, origin));
+    shape->marker_line_width = 3;
+    shape->marker_line = (mesh_color_t){PURPLE.r, PURPLE.g, PURPLE.b, 200};
+    shape->marker_fill = (mesh_color_t){PURPLE.r, PURPLE.g, PURPLE.b, 100};
+  }
+}
+
+// Text of a card, drawn over its geometry
+static void draw_card_text(const layout_template_t *template, const card_view_t *card, const schedule_item_t *item,
+                           label_cache_t *labels, const item_labels_t *item_labels, Vector2 origin)
+{
+  Rectangle titleRect = layout_stamp(template, card->title, origin);
+  DrawText(text_cache_fit(labels->text, item->title, scaling_apply_y(20), titleRect.width, 1),
+           titleRect.x,
+           titleRect.y,
+           scaling_apply_y(20),
+           BLACK);
+
+  Rectangle timeRect = layout_stamp(template, card->time, origin);
+  DrawText(item_labels->duration,
+           timeRect.x,
+           timeRect.y,
+           scaling_apply_y(20),
+           BLACK);
+
+  Rectangle percentageRect = layout_stamp(template, card->percentage, origin);
+  float percentageX = percentageRect.x + percentageRect.width - item_labels->percentage_width;
+  DrawText(item_labels->percentage, percentageX, percentageRect.y,
+           scaling_apply_y(LABEL_FONT_SIZE), BLACK);
+
+  if (item_labels->current)
+  {
+    Rectangle markerRect = layout_stamp(template, card->marker, origin);
+    float textY = markerRect.y + (scaling_apply_y(20) - scaling_apply_y(13)) / 2;
+    float textX = markerRect.x + (markerRect.width - labels->current_width) / 2;
+    DrawText("Current", textX, textY, scaling_apply_y(13), BLACK);
+  }
+}
+
+// What drawing one card needs from the frame draw_schedule is drawing
+typedef struct list_frame
+{
+  schedule_t *schedule;
+  label_cache_t *labels;
+  const int *filter;
+  time_t now;
+  float top;
+  float gap;
+  float padding_x;
+  float card_width;
+} list_frame_t;
+
+// Template and origin of card i, the position in the list
+static const layout_template_t *schedule_view_place(schedule_view_t *view, const list_frame_t *frame, int i, Vector2 *origin)
+{
+  float height = offsets_height(view->offsets, i);
+  *origin = (Vector2){frame->padding_x, frame->top + offsets_y(view->offsets, i)};
+  return schedule_view_template(view, (Vector2){frame->card_width, height - frame->gap});
+}
+
+// Builds card i into the batch unless it's there already as it looks now
+static void schedule_view_shape(schedule_view_t *view, const list_frame_t *frame, int i)
+{
+  if (card_mesh_holds(view->batch->mesh, i, view->states[i]))
+    return;
+
+  int index = frame->filter ? frame->filter[i] : i;
+  Vector2 origin;
+  const layout_template_t *template = schedule_view_place(view, frame, i, &origin);
+  mesh_card_t shape;
+  card_shape(template, &view->card, &frame->schedule->items[index], label_cache_get(frame->labels, index, frame->now),
+             origin, i == view->hover, index == view->selected, &shape);
+  card_mesh_set(view->batch->mesh, i, view->states[i], &shape);
+}
+
+static void schedule_view_text(schedule_view_t *view, const list_frame_t *frame, int i)
+{
+  int index = frame->filter ? frame->filter[i] : i;
+  Vector2 origin;
+  const layout_template_t *template = schedule_view_place(view, frame, i, &origin);
+  draw_card_text(template, &view->card, &frame->schedule->items[index], frame->labels,
+                 label_cache_get(frame->labels, index, frame->now), origin);
+}
+
+// Draws the items listed in filter, or all of them when filter is NULL. Cards
+// are kept rendered in tiles, bands of the list as tall as half the viewport,
+// and the screen is the two or three tiles it overlaps. A tile is drawn in
+// full when it comes into view, after that only the cards whose state word
+// changed are drawn over, mostly the current item as its bar grows.
+void draw_schedule(schedule_view_t *view, schedule_t *schedule, label_cache_t *labels, const int *filter, int filter_count, scrollable_t *scrollable)
+{
+  int count = filter ? filter_count : schedule->count;
+  time_t now = time(NULL);
+
+  float padding_x = scaling_apply_x(LIST_PADDING);
+  float padding_y = scaling_apply_y(LIST_PADDING);
+  float gap = scaling_apply_y(CARD_GAP);
+  float top = scaling_apply_y(50) + padding_y; // Content y of the first card
+
+  bool rescaled = scaling_get_epoch() != view->scale_epoch;
+  if (!rescaled && !view->offsets_stale && view->changed_from >= 0)
+  {
+    // Cards keep their heights, so the ones before the change keep their place
+    // and only the tiles from its slot down are dropped
+    if (view->offsets->count != count)
+      offsets_reset(view->offsets, count, scaling_apply_y(CARD_HEIGHT) + gap);
+    int first = view->changed_from < count ? view->changed_from : count;
+    tile_cache_drop_from(view->tiles, top + offsets_y(view->offsets, first) - gap / 2);
+    card_mesh_forget(view->batch->mesh, first);
+  }
+  else if (rescaled || view->offsets_stale || view->offsets->count != count)
+  {
+    // Every card is the same height for now, the index is what lets them differ
+    offsets_reset(view->offsets, count, scaling_apply_y(CARD_HEIGHT) + gap);
+    view->offsets_stale = false;
+    tile_cache_invalidate(view->tiles);
+  }
+  view->changed_from = -1;
+
+  // Height the list would have laid out in full, as fbox reports it
+  float content = count > 0 ? (2 * padding_y) + offsets_total(view->offsets) - gap : 0;
+  scrollable->last_y_pos = fmaxf(scrollable->last_y_pos, content);
+
+  if (view->scroll_to >= 0 && view->scroll_to < count)
+  {
+    float max_scroll = fmaxf(0, content - scrollable->bounds.height);
+    scrollable->scroll_offset = fminf(offsets_y(view->offsets, view->scroll_to), max_scroll);
+  }
+  view->scroll_to = -1;
+  view->hover = schedule_view_hit(view, scrollable, GetMousePosition());
+
+  if (rescaled || view->layout->count == 0)
+  {
+    schedule_view_build(view, labels);
+  }
+
+  tile_cache_resize(view->tiles, scrollable->bounds.width, scrollable->bounds.height);
+  if (count > view->states_capacity)
+  {
+    view->states_capacity = count;
+    view->states = (unsigned int *)realloc(view->states, sizeof(unsigned int) * 2 * count);
+    view->drawn = view->states + count;
+    view->states_generation = 0;
+  }
+  if (view->states_generation != view->tiles->generation)
+  {
+    memset(view->drawn, 0, sizeof(unsigned int) * view->states_capacity); // Nothing is in the tiles
+    card_mesh_clear(view->batch->mesh);                                      // Nor where it was
+    view->states_generation = view->tiles->generation;
+  }
+
+  // Tiles on screen, in the coordinates cards are drawn in before the scroll
+  int tile_height = view->tiles->height;
+  float view_top = scrollable->bounds.y + scrollable->scroll_offset;
+  float view_bottom = view_top + scrollable->bounds.height;
+  int first_tile = (int)(view_top / tile_height);
+  int last_tile = (int)((view_bottom - 1) / tile_height);
+  if (last_tile - first_tile >= TILE_CACHE_TILES / 2)
+    last_tile = first_tile + TILE_CACHE_TILES / 2 - 1;
+  tile_t *tiles[TILE_CACHE_TILES / 2];
+  bool fresh[TILE_CACHE_TILES / 2];
+  for (int t = first_tile; t <= last_tile; t++)
+  {
+    tiles[t - first_tile] = tile_cache_get(view->tiles, t, &fresh[t - first_tile]);
+  }
+
+  // State of every card in those tiles. Each card owns a slot from halfway
+  // through the gap above it to halfway through the gap below, which holds
+  // its outline, and is drawn over by clearing just that.
+  float band_top = first_tile * tile_height;
+  float band_bottom = (last_tile + 1) * tile_height;
+  float card_width = scrollable->bounds.width - (2 * padding_x);
+  int first = offsets_find(view->offsets, fmaxf(0, band_top - top + gap / 2));
+  int last = first - 1;
+  view->next_change = 0;
+  for (int i = first; i < count; i++)
+  {
+    float slot_top = top + offsets_y(view->offsets, i) - gap / 2;
+    if (slot_top >= band_bottom)
+      break;
+    last = i;
+
+    int index = filter ? filter[i] : i;
+    const item_labels_t *item_labels = label_cache_get(labels, index, now);
+    int bar = (int)(card_width * item_labels->completion / 100.0f);
+    view->states[i] = card_state(item_labels, bar, i == view->hover, index == view->selected);
+
+    float slot_bottom = slot_top + offsets_height(view->offsets, i);
+    if (slot_bottom > view_top && slot_top < view_bottom)
+    {
+      time_t change = card_next_change(&schedule->items[index], item_labels, bar, card_width, now);
+      if (change > 0 && (view->next_change == 0 || change < view->next_change))
+        view->next_change = change;
     }
+  }
 
-    { // Percentage progress and current marker
-      Rectangle item_progress_rect = fbox_next(&item_content_fbox, (Vector2){0, itemRect.height});
-      fbox_context_t item_progress = fbox_create_nested(&item_content_fbox, item_progress_rect);
-      fbox_set_direction(&item_progress, fbox_DIRECTION_COLUMN);
-      fbox_set_main_align(&item_progress, fbox_ALIGN_START);
-      fbox_set_cross_align(&item_progress, fbox_ALIGN_END);
-      fbox_set_expected_items(&item_progress, 2);
+  // Draw into the tiles on screen and the ones either side, a card straddling
+  // two tiles has to look the same in both. A tile coming into view gets the
+  // geometry of all its cards in one call and their text after, a card that
+  // changed is cleared and drawn on its own.
+  list_frame_t frame = {schedule, labels, filter, now, top, gap, padding_x, card_width};
+  int slots = view->batch->mesh->slots;
+  scrollable_suspend(scrollable);
+  for (int t = first_tile - 1; t <= last_tile + 1; t++)
+  {
+    bool visible = t >= first_tile && t <= last_tile;
+    tile_t *tile = visible ? tiles[t - first_tile] : tile_cache_find(view->tiles, t);
+    if (!tile)
+      continue;
+    float tile_top = (float)t * tile_height;
+    float tile_bottom = tile_top + tile_height;
 
-      char *percentage_text = format_percentage(completion);
-      int percentage_width = MeasureText(percentage_text, scaling_apply_y(13));
-      Rectangle progressRect = fbox_next(&item_progress,
-                                         (Vector2){percentage_width, scaling_apply_y(20)});
+    // Cards of the tile, from the ones whose state is known this frame
+    int tile_first = last + 1;
+    int tile_last = first - 1;
+    for (int i = first; i <= last; i++)
+    {
+      float slot_top = top + offsets_y(view->offsets, i) - gap / 2;
+      if (slot_top + offsets_height(view->offsets, i) <= tile_top || slot_top >= tile_bottom)
+        continue;
+      if (i < tile_first)
+        tile_first = i;
+      tile_last = i;
+    }
 
-      DrawText(percentage_text, progressRect.x, progressRect.y,
-               scaling_apply_y(13), BLACK);
-      free(percentage_text);
+    if (visible && fresh[t - first_tile])
+    {
+      tile_cache_begin(view->tiles, tile);
+      ClearBackground(RAYWHITE);
+      for (int chunk = tile_first; chunk <= tile_last; chunk += slots)
+      {
+        int chunk_last = chunk + slots - 1 < tile_last ? chunk + slots - 1 : tile_last;
+        for (int i = chunk; i <= chunk_last; i++)
+        {
+          schedule_view_shape(view, &frame, i);
+        }
+        card_batch_draw(view->batch, chunk, chunk_last);
+        for (int i = chunk; i <= chunk_last; i++)
+        {
+          schedule_view_text(view, &frame, i);
+        }
+      }
+      tile_cache_end();
+      continue;
+    }
 
-      if (is_current)
+    bool drawing = false;
+    for (int i = tile_first; i <= tile_last; i++)
+    {
+      if (view->states[i] == view->drawn[i])
+        continue;
+      if (!drawing)
       {
-        int markerWidth = MeasureText("Current", scaling_apply_y(13));
-        Rectangle markerRect = fbox_next(&item_progress,
-                                         (Vector2){markerWidth + 10, scaling_apply_y(20)});
-        float textY = markerRect.y + (scaling_apply_y(20) - scaling_apply_y(13)) / 2;
-        float textX = markerRect.x + (markerWidth + 10 - markerWidth) / 2;
-        DrawText("Current", textX, textY, scaling_apply_y(13), BLACK);
-        DrawRectangleRoundedLinesEx((Rectangle){markerRect.x, markerRect.y, markerWidth + 10, scaling_apply_y(20)}, 0.1f, 8, 3, (Color){PURPLE.r, PURPLE.g, PURPLE.b, 200});
-        DrawRectangleRounded((Rectangle){markerRect.x, markerRect.y, markerWidth + 10, scaling_apply_y(20)}, 0.1f, 8, (Color){PURPLE.r, PURPLE.g, PURPLE.b, 100});
+        tile_cache_begin(view->tiles, tile);
+        drawing = true;
       }
+      float slot_top = top + offsets_y(view->offsets, i) - gap / 2;
+      BeginScissorMode(0, slot_top - tile_top, view->tiles->width, offsets_height(view->offsets, i));
+      ClearBackground(RAYWHITE);
+      schedule_view_shape(view, &frame, i);
+      card_batch_draw(view->batch, i, i);
+      schedule_view_text(view, &frame, i);
+      EndScissorMode();
+    }
+    if (drawing)
+      tile_cache_end();
+  }
+  scrollable_resume(scrollable);
+
+  for (int i = first; i <= last; i++)
+  {
+    view->drawn[i] = view->states[i];
+  }
+  for (int t = first_tile; t <= last_tile; t++)
+  {
+    tile_cache_draw(view->tiles, tiles[t - first_tile], 0);
+  }
+}
+
+// Everything the main loop keeps between frames
+typedef struct app
+{
+  calendar_t *calendar;
+  int today;            // Date the clock was on last frame
+  int date;             // Date on screen
+  schedule_t *schedule; // Schedule on screen, never NULL
+  schedule_t empty;     // Shown for days without a schedule file
+  history_t *history;
+  scrollable_t *scrollable;
+  label_cache_t *labels; // Item text, rebuilt when the schedule version moves
+  header_view_t header;
+  schedule_view_t list;
+  file_watch_t *watch; // Says when the schedule folder changes, NULL to check on an interval
+  double last_reload_check;
+
+  // Search is typed after ctrl+f or /, and filters the list as you type
+  search_index_t *search_index;
+  bool search_dirty; // Index no longer matches the schedule
+  int search_from;   // from this item on
+  bool searching;
+  char search[SEARCH_MAX_QUERY];
+  const int *search_results;
+  int search_count;
+
+  // Reminders always follow today, whatever day is on screen
+  reminder_engine_t *reminders;
+  char notice[160];    // Last reminder, shown in the header
+  double notice_until; // GetTime() at which it goes away
+  char details[160];   // Selected item, shown in the header when there's no reminder
+
+  idle_timer_t *idle;   // Wakes the loop for the next change nobody typed
+  unsigned long frames; // Drawn, for the log on exit
+} app_t;
+
+static void app_on_reminder(const schedule_item_t *item, reminder_kind_t kind, void *user_data)
+{
+  app_t *app = (app_t *)user_data;
+  switch (kind)
+  {
+  case REMINDER_START_SOON:
+    snprintf(app->notice, sizeof(app->notice), "Starting in %d min: %s", REMINDER_LEAD / 60, item->title);
+    break;
+  case REMINDER_START:
+    snprintf(app->notice, sizeof(app->notice), "Now: %s", item->title);
+    break;
+  case REMINDER_END_SOON:
+    snprintf(app->notice, sizeof(app->notice), "Ending in %d min: %s", REMINDER_LEAD / 60, item->title);
+    break;
+  case REMINDER_END:
+    snprintf(app->notice, sizeof(app->notice), "Finished: %s", item->title);
+    break;
+  }
+  app->notice_until = GetTime() + REMINDER_SHOWN;
+  TraceLog(LOG_INFO, "Reminder: %s", app->notice);
+}
+
+// Called whenever the items of the schedule on screen change
+// Items from first on changed, the ones before it are as they were
+static void app_schedule_changed(app_t *app, int first)
+{
+  if (app->list.selected >= first)
+    app->list.selected = -1; // The index may point at another item now
+  app->list.hover = -1;      // Found on the old items, until the list is drawn again
+  if (!app->search_dirty || first < app->search_from)
+    app->search_from = first;
+  app->search_dirty = true;
+  schedule_view_patch(&app->list, first);
+  label_cache_patch(app->labels, first);
+  if (app->date == app->today)
+  {
+    reminder_load(app->reminders, app->schedule, time(NULL));
+  }
+}
+
+// The user changed the items from first on. Unlike a reload these are only in
+// memory, so they're written back to the day's file straight away, or a later
+// reload would replace them without a word.
+static void app_edited(app_t *app, int first)
+{
+  app_schedule_changed(app, first);
+  if (!calendar_save_day(app->calendar, app->date))
+  {
+    snprintf(app->notice, sizeof(app->notice), "Couldn't save the schedule, a reload will undo the edit");
+    app->notice_until = GetTime() + REMINDER_SHOWN;
+    TraceLog(LOG_WARNING, "Failed to save schedule file for the edit");
+  }
+}
+
+static void app_select(app_t *app, int index)
+{
+  app->list.selected = index;
+  if (index < 0)
+    return;
+
+  const schedule_item_t *item = &app->schedule->items[index];
+  char duration[FORMAT_DURATION_SIZE];
+  format_duration_12hr(item->start, item->end, duration, sizeof(duration));
+  snprintf(app->details, sizeof(app->details), "%s, %s", item->title, duration);
+}
 
-      fbox_destroy(&item_progress);
+static void app_show_day(app_t *app, int date)
+{
+  parse_error_t error;
+  app->date = date;
+  app->schedule = calendar_get_day(app->calendar, date, &error);
+  if (!app->schedule)
+  {
+    if (error != PARSE_ERROR_FILE_NOT_FOUND)
+      TraceLog(LOG_WARNING, "Failed to parse schedule file: %s", parse_error_to_string(error));
+    app->schedule = &app->empty;
+  }
+  app->scrollable->scroll_offset = 0;
+  history_reset(app->history, app->schedule);
+  app_schedule_changed(app, 0);
+}
+
+// Edits to the selected item: delete removes it, ctrl+d puts a copy right
+// after it and ctrl+up or ctrl+down moves it EDIT_STEP earlier or later.
+// Each is one version in the history, see history.h.
+static void app_edit_selected(app_t *app, bool ctrl)
+{
+  int index = app->list.selected;
+  schedule_item_t item = app->schedule->items[index];
+
+  if (IsKeyPressed(KEY_DELETE))
+  {
+    if (history_remove_item(app->history, index))
+      app_edited(app, index);
+  }
+  else if (ctrl && IsKeyPressed(KEY_D))
+  {
+    if (history_insert_item(app->history, index + 1, item))
+      app_edited(app, index + 1);
+  }
+  else if (ctrl && (IsKeyPressed(KEY_UP) || IsKeyPressed(KEY_DOWN)))
+  {
+    time_t step = IsKeyPressed(KEY_UP) ? -EDIT_STEP : EDIT_STEP;
+    item.start += step;
+    item.end += step;
+
+    // Times are saved as a time of day, so the item can't leave its day
+    if (tzcache_date(item.start) != app->date || tzcache_date(item.end) != app->date)
+      return;
+    if (history_set_item(app->history, index, item))
+    {
+      app_edited(app, index);
+      app_select(app, index);
     }
-    fbox_destroy(&item_content_fbox);
   }
+}
 
-  destroy_iterator(iterator);
-  fbox_destroy(&items_fbox);
+// Reads tomorrow in the background ahead of midnight, and follows the clock
+// into the new day when it comes. The swap itself is a pointer change, so a
+// kiosk left running rolls over without a hitch or a restart.
+static void app_update_day(app_t *app)
+{
+  calendar_poll(app->calendar);
+
+  int today = date_today();
+  if (make_date_time(today + 1, 0, 0) - time(NULL) <= PREFETCH_LEAD)
+  {
+    calendar_prefetch_day(app->calendar, today + 1);
+  }
+
+  if (today == app->today)
+    return;
+
+  // Leave the view alone if the user navigated elsewhere
+  bool follow = app->date == app->today;
+  app->today = today;
+  if (follow)
+  {
+    app_show_day(app, today);
+  }
+  else
+  {
+    schedule_t *schedule = calendar_get_day(app->calendar, today, NULL);
+    reminder_load(app->reminders, schedule ? schedule : &app->empty, time(NULL));
+  }
+  if (app->date != today - 2)
+  {
+    calendar_unload_day(app->calendar, today - 2);
+  }
 }
 
-static char *find_today_schedule_file(char *schedule_folder)
+// Matches for the query on the schedule on screen, indexing the items that
+// changed again first
+static void app_run_search(app_t *app)
 {
+  if (app->search_dirty)
+  {
+    search_update(app->search_index, app->schedule, app->search_from);
+    app->search_dirty = false;
+  }
+  app->search_count = search_query(app->search_index, app->search, false, &app->search_results);
+}
+
+// Matches are positions in the schedule they were searched in. Anything that
+// changes the schedule, a day switch at midnight, a reload, an edit or an
+// undo, marks them dirty, and this searches again before they are used.
+static void app_refresh_search(app_t *app)
+{
+  if (app->searching && app->search_dirty)
+  {
+    app_run_search(app);
+    schedule_view_invalidate(&app->list); // The cards shown are other items now
+  }
+}
+
+// Goes back to today, scrolled to the item on now or the next one coming up
+static void app_jump_to_now(app_t *app)
+{
+  if (app->date != app->today)
+  {
+    app_show_day(app, app->today);
+  }
+  app_refresh_search(app);
+
   time_t now = time(NULL);
-  struct tm tm;
-  localtime_r(&now, &tm);
+  int count = app->searching ? app->search_count : app->schedule->count;
+  int position = count - 1;
+  for (int i = 0; i < count; i++)
+  {
+    if (app->schedule->items[app->searching ? app->search_results[i] : i].end >= now)
+    {
+      position = i;
+      break;
+    }
+  }
+  schedule_view_scroll_to(&app->list, position);
+}
+
+static void app_update_search(app_t *app, bool ctrl)
+{
+  app_refresh_search(app); // Enter below scrolls to a match
+  bool changed = false;
+  if (!app->searching && ((ctrl && IsKeyPressed(KEY_F)) || IsKeyPressed(KEY_SLASH)))
+  {
+    app->searching = true;
+    app->search[0] = '\0';
+    changed = true;
+    GetCharPressed(); // Don't type the slash
+  }
+  else if (app->searching)
+  {
+    size_t length = strlen(app->search);
+    for (int c = GetCharPressed(); c > 0; c = GetCharPressed())
+    {
+      if (c >= 32 && c < 127 && length < sizeof(app->search) - 1)
+      {
+        app->search[length++] = (char)c;
+        app->search[length] = '\0';
+        changed = true;
+      }
+    }
+    if ((IsKeyPressed(KEY_BACKSPACE) || IsKeyPressedRepeat(KEY_BACKSPACE)) && length > 0)
+    {
+      app->search[--length] = '\0';
+      changed = true;
+    }
+    if (IsKeyPressed(KEY_ESCAPE))
+    {
+      app->searching = false;
+      app->scrollable->scroll_offset = 0;
+      schedule_view_invalidate(&app->list);
+    }
+    else if (IsKeyPressed(KEY_ENTER) && app->search_count > 0)
+    {
+      // Back to the whole day, scrolled to the first match
+      app->searching = false;
+      schedule_view_invalidate(&app->list);
+      schedule_view_scroll_to(&app->list, app->search_results[0]);
+    }
+  }
+
+  if (changed)
+  {
+    app_run_search(app);
+    app->scrollable->scroll_offset = 0;
+    schedule_view_invalidate(&app->list);
+  }
+}
+
+// Earliest of wake and a time on screen, kept past the current second so a
+// deadline that already went can't spin the loop
+static double idle_earliest(double wake, time_t at, double now)
+{
+  return fmin(wake, fmax(at, floor(now) + 1));
+}
+
+// Sleeps the loop until the next thing on screen changes: the clock minute, an
+// item starting or ending, a percentage or progress bar pixel of a card in
+// view, a reminder, the notice going away, or the next check for file changes
+// without a watch to say
+static void app_wake_for_next_change(app_t *app)
+{
+  double now = idle_now();
+  double wake = (floor(now / 60) + 1) * 60;
+  if (app->list.next_change > 0)
+    wake = idle_earliest(wake, app->list.next_change, now);
+  if (app->labels->next_status > 0)
+    wake = idle_earliest(wake, app->labels->next_status, now);
+  time_t reminder = reminder_next_deadline(app->reminders);
+  if (reminder >= 0)
+    wake = idle_earliest(wake, reminder, now);
+
+  // Those two run off GetTime()
+  double monotonic = GetTime();
+  if (monotonic < app->notice_until)
+    wake = fmin(wake, now + app->notice_until - monotonic);
+  if (!app->watch)
+    wake = fmin(wake, now + app->last_reload_check + RELOAD_INTERVAL - monotonic);
+
+  idle_wake_in(app->idle, fmin(wake - now + IDLE_SLACK, IDLE_LONGEST));
+}
 
-  char *days[] = {"sunday", "monday", "tuesday", "wednesday", "thursday", "friday", "saturday"};
-  char *day = days[tm.tm_wday];
+// Whether to look for changed schedule files this frame: when the watch saw
+// something, or every RELOAD_INTERVAL without one
+static bool reload_due(file_watch_t *watch, double *last_check)
+{
+  if (watch)
+    return file_watch_take(watch);
+  if (GetTime() - *last_check < RELOAD_INTERVAL)
+    return false;
+  *last_check = GetTime();
+  return true;
+}
+
+static void app_open_window(void)
+{
+  SetConfigFlags(FLAG_WINDOW_RESIZABLE); // No MSAA, the card shader antialiases its own edges
+  SetTraceLogLevel(LOG_WARNING);
+  InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Daily Schedule");
+  SetExitKey(KEY_NULL); // Escape closes the search first, see the main loop
+  format_init();
+  SetTargetFPS(60);
+  EnableEventWaiting(); // Frames are drawn on input, or when idle_wake_in says
 
-  // full path: folder + "/" + day + ".schedule" + null terminator
-  char *filepath = malloc(strlen(schedule_folder) + 1 + strlen(day) + 9 + 1);
-  if (!filepath)
+  scaling_init(WINDOW_WIDTH, WINDOW_HEIGHT);
+}
+
+// Lobby screen mode, every room in folder side by side on one grid that
+// follows today
+static int run_wall(const char *folder)
+{
+  wall_t *wall = wall_create(folder);
+  if (!wall)
   {
-    return NULL;
+    printf("No room folders found in %s\n", folder);
+    return 1;
   }
 
-  sprintf(filepath, "%s/%s.schedule", schedule_folder, day);
-  FILE *f = fopen(filepath, "r");
-  if (!f)
+  app_open_window();
+  label_cache_t *labels = label_cache_create();
+  header_view_t header;
+  header_view_init(&header);
+  schedule_t empty = {0}; // The header only needs the clock
+  char details[160];      // Selected cell, shown in the header
+  double last_reload_check = GetTime();
+  bool follow_now = true; // Scroll to now once the first frame knows its size
+  idle_timer_t *idle = idle_create();
+  if (!idle)
+    DisableEventWaiting();
+  file_watch_t *watch = file_watch_create();
+  for (int i = 0; watch && i < wall->count; i++)
   {
-    free(filepath);
-    return NULL;
+    if (!file_watch_add(watch, wall->columns[i].calendar->folder))
+    {
+      file_watch_destroy(watch);
+      watch = NULL;
+    }
   }
-  fclose(f);
 
-  return filepath;
+  while (!WindowShouldClose())
+  {
+    time_t now = time(NULL);
+    tzcache_refresh(now);
+
+    // Every room reads tomorrow in the background ahead of midnight, the
+    // switch then only picks up what's loaded
+    int today = date_today();
+    if (make_date_time(today + 1, 0, 0) - now <= PREFETCH_LEAD)
+    {
+      wall_prefetch_day(wall, today + 1);
+    }
+    if (wall->date != today)
+    {
+      wall_show_day(wall, today);
+      follow_now = true;
+    }
+    bool reading = wall_poll(wall);
+    if (IsKeyPressed(KEY_HOME))
+    {
+      follow_now = true;
+    }
+    if (reload_due(watch, &last_reload_check))
+    {
+      wall_reload(wall);
+    }
+    if (IsKeyPressed(KEY_ESCAPE))
+    {
+      if (wall->selected_column < 0)
+        break;
+      wall->selected_column = -1;
+    }
+
+    BeginDrawing();
+
+    ClearBackground(RAYWHITE);
+    scaling_update();
+    label_cache_update(labels, &empty, now);
+
+    Rectangle bounds = {0, scaling_apply_y(50), GetScreenWidth(), GetScreenHeight() - scaling_apply_y(50)};
+    if (follow_now)
+    {
+      wall_scroll_to_now(wall, bounds, now);
+      follow_now = false;
+    }
+    wall_update(wall, bounds);
+    wall_draw(wall, bounds, now);
+
+    const char *notice = NULL;
+    if (wall->selected_column >= 0)
+    {
+      const wall_column_t *room = &wall->columns[wall->selected_column];
+      const schedule_item_t *item = &room->schedule->items[wall->selected_item];
+      char duration[FORMAT_DURATION_SIZE];
+      format_duration_12hr(item->start, item->end, duration, sizeof(duration));
+      snprintf(details, sizeof(details), "%s: %s, %s", room->name, item->title, duration);
+      notice = details;
+    }
+    draw_header(&header, labels, wall->date, NULL, notice);
+
+    // The now line moves a pixel every few seconds at most, the clock once a
+    // minute. File changes wake the loop themselves, unless there's no watch.
+    if (idle)
+    {
+      double wake = fmin(60 - fmod(idle_now(), 60) + IDLE_SLACK, wall_seconds_per_pixel());
+      if (!watch)
+        wake = fmin(wake, last_reload_check + RELOAD_INTERVAL - GetTime());
+      if (reading)
+        wake = fmin(wake, PREFETCH_POLL);
+      idle_wake_in(idle, fmax(0, wake));
+    }
+    EndDrawing();
+  }
+
+  file_watch_destroy(watch);
+  idle_destroy(idle);
+  label_cache_destroy(labels);
+  layout_destroy(header.layout);
+  wall_destroy(wall);
+  scaling_cleanup();
+  CloseWindow();
+  return 0;
 }
 
 int main(int argc, char **argv)
 {
+  if (argc == 3 && strcmp(argv[1], "--wall") == 0)
+  {
+    return run_wall(argv[2]);
+  }
   if (argc != 2)
   {
-    printf("Scheduler %s\nUsage: %s <schedule_folder>\n", VERSION, argv[0]);
+    printf("Scheduler %s\nUsage: %s <schedule_folder>\n       %s --wall <rooms_folder>\n", VERSION, argv[0], argv[0]);
     return 1;
   }
 
-  char *schedule_folder = argv[1];
-  char *today_schedule_file = find_today_schedule_file(schedule_folder);
-  if (!today_schedule_file)
+  app_t app = {0};
+  app.calendar = calendar_create(argv[1]);
+  if (!app.calendar)
   {
-    printf("No schedule file found for today\n");
+    printf("Failed to create calendar\n");
     return 1;
   }
 
   parse_error_t error;
-  schedule_t *schedule = parse_schedule_file(today_schedule_file, &error);
-  if (!schedule)
+  app.today = date_today();
+  app.date = app.today;
+  app.schedule = calendar_get_day(app.calendar, app.date, &error);
+  if (!app.schedule)
   {
-    printf("Failed to parse schedule file: %s\n", parse_error_to_string(error));
-    free(today_schedule_file);
+    if (error == PARSE_ERROR_FILE_NOT_FOUND)
+      printf("No schedule file found for today\n");
+    else
+      printf("Failed to parse schedule file: %s\n", parse_error_to_string(error));
+    calendar_destroy(app.calendar);
     return 1;
   }
 
-  SetConfigFlags(FLAG_MSAA_4X_HINT | FLAG_WINDOW_RESIZABLE);
-  SetConfigFlags(FLAG_MSAA_4X_HINT | FLAG_WINDOW_RESIZABLE);
-  SetTraceLogLevel(LOG_WARNING);
-  InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Daily Schedule");
-  SetTargetFPS(60);
-
-  scaling_init(WINDOW_WIDTH, WINDOW_HEIGHT);
+  app_open_window();
 
-  scrollable_t *scrollable = create_scrollable((Rectangle){
+  app.scrollable = create_scrollable((Rectangle){
       0, scaling_apply_y(50),
       WINDOW_WIDTH,
       WINDOW_HEIGHT - scaling_apply_y(50)});
 
+  app.history = history_create(app.schedule, HISTORY_DEPTH);
+  app.last_reload_check = GetTime();
+  app.watch = file_watch_create();
+  if (app.watch && !file_watch_add(app.watch, argv[1]))
+  {
+    file_watch_destroy(app.watch);
+    app.watch = NULL;
+  }
+  app.labels = label_cache_create();
+  header_view_init(&app.header);
+  app.list.layout = layout_create();
+  app.list.offsets = offsets_create();
+  app.list.scroll_to = -1;
+  app.list.changed_from = -1;
+  app.list.hover = -1;
+  app.list.selected = -1;
+  app.list.tiles = tile_cache_create();
+  app.list.batch = card_batch_create(CARD_BATCH_SLOTS);
+  if (!app.list.batch)
+  {
+    printf("Failed to set up card drawing\n");
+    CloseWindow();
+    calendar_destroy(app.calendar);
+    return 1;
+  }
+  int cursor = MOUSE_CURSOR_DEFAULT;
+  app.search_index = search_create();
+  app.search_dirty = true;
+  app.search_from = 0;
+  app.reminders = reminder_create(REMINDER_LEAD, app_on_reminder, &app);
+  reminder_load(app.reminders, app.schedule, time(NULL));
+  app.idle = idle_create();
+  if (!app.idle)
+    DisableEventWaiting(); // Nothing to wake it, draw every frame as before
+
   while (!WindowShouldClose())
   {
+    tzcache_refresh(time(NULL));
+    app_update_day(&app);
+
+    bool ctrl = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+    bool shift = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+
+    // Day navigation, shift moves a week at a time. Only the days visited are
+    // ever read from disk.
+    int step = shift ? 7 : 1;
+    if (IsKeyPressed(KEY_RIGHT) || IsKeyPressed(KEY_LEFT))
+    {
+      app_show_day(&app, app.date + (IsKeyPressed(KEY_RIGHT) ? step : -step));
+    }
+    if (IsKeyPressed(KEY_HOME))
+    {
+      app_jump_to_now(&app);
+    }
+
+    if (reload_due(app.watch, &app.last_reload_check))
+    {
+      diff_t *changes = calendar_reload_day(app.calendar, app.date, &error);
+      if (changes)
+      {
+        TraceLog(LOG_INFO, "Reloaded schedule: %d changes, %d unchanged", changes->count, changes->unchanged);
+        if (app.schedule == &app.empty)
+        {
+          app_show_day(&app, app.date); // The day had no schedule until now
+        }
+        else if (history_replace(app.history, changes))
+        {
+          // The reload is one undo step, and only the cards from the first
+          // change down are drawn again
+          app_schedule_changed(&app, diff_first_change(changes));
+        }
+        diff_destroy(changes);
+      }
+    }
+
+    if (ctrl && (IsKeyPressed(KEY_Y) || (shift && IsKeyPressed(KEY_Z))))
+    {
+      if (history_redo(app.history))
+        app_edited(&app, app.history->changed_from);
+    }
+    else if (ctrl && IsKeyPressed(KEY_Z))
+    {
+      if (history_undo(app.history))
+        app_edited(&app, app.history->changed_from);
+    }
+
+    reminder_poll(app.reminders, time(NULL));
+
+    // Clicking a card selects it, clicking between cards lets go. The card is
+    // the one under the mouse when the list was last drawn.
+    Vector2 mouse = GetMousePosition();
+    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && scrollable_contains(app.scrollable, mouse))
+    {
+      int position = app.list.hover;
+      app_select(&app, position < 0 ? -1 : app.searching ? app.search_results[position] : position);
+    }
+    if (app.list.selected >= 0)
+      app_edit_selected(&app, ctrl);
+
+    if (!app.searching && IsKeyPressed(KEY_ESCAPE))
+    {
+      if (app.list.selected < 0)
+        break;
+      app_select(&app, -1);
+    }
+    app_update_search(&app, ctrl);
+
     BeginDrawing();
 
     ClearBackground(RAYWHITE);
     scaling_update();
+    label_cache_update(app.labels, app.schedule, time(NULL));
 
-    begin_scrollable(scrollable);
-    draw_schedule(schedule, scrollable);
-    end_scrollable(scrollable);
+    begin_scrollable(app.scrollable);
+    draw_schedule(&app.list, app.schedule, app.labels, app.searching ? app.search_results : NULL, app.search_count, app.scrollable);
+    end_scrollable(app.scrollable);
 
-    draw_header();
+    draw_header(&app.header,
+                app.labels,
+                app.date,
+                app.searching ? app.search : NULL,
+                GetTime() < app.notice_until ? app.notice : app.list.selected >= 0 ? app.details
+                                                                                     : NULL);
 
+    if (app.idle)
+      app_wake_for_next_change(&app);
+    app.frames++;
     EndDrawing();
+
+    if ((app.list.hover >= 0) != (cursor == MOUSE_CURSOR_POINTING_HAND))
+    {
+      cursor = app.list.hover >= 0 ? MOUSE_CURSOR_POINTING_HAND : MOUSE_CURSOR_DEFAULT;
+      SetMouseCursor(cursor);
+    }
   }
 
-  destroy_schedule(schedule);
-  destroy_scrollable(scrollable);
+  TraceLog(LOG_INFO, "Drew %lu frames in %.0f seconds", app.frames, GetTime());
+  file_watch_destroy(app.watch);
+  idle_destroy(app.idle);
+  reminder_destroy(app.reminders);
+  label_cache_destroy(app.labels);
+  layout_destroy(app.header.layout);
+  layout_destroy(app.list.layout);
+  for (int i = 0; i < CARD_TEMPLATES; i++)
+  {
+    layout_template_free(&app.list.templates[i]);
+  }
+  offsets_destroy(app.list.offsets);
+  tile_cache_destroy(app.list.tiles);
+  card_batch_destroy(app.list.batch);
+  free(app.list.states);
+  search_destroy(app.search_index);
+  history_destroy(app.history);
+  free(app.empty.items);
+  calendar_destroy(app.calendar);
+  destroy_scrollable(app.scrollable);
   scaling_cleanup();
   CloseWindow();
-  free(today_schedule_file);
 
   return 0;
 }
@@ -0,0 +1,104 @@
+#include <stdlib.h>
+#include "offsets.h"
+
+offset_index_t *offsets_create(void)
+{
+  return (offset_index_t *)calloc(1, sizeof(offset_index_t));
+}
+
+void offsets_destroy(offset_index_t *index)
+{
+  if (index == NULL)
+    return;
+
+  free(index->tree);
+  free(index->heights);
+  free(index);
+}
+
+bool offsets_reset(offset_index_t *index, int count, float height)
+{
+  // A fresh index has no tree yet even for an empty list, tree[0] is always
+  // written
+  if (count > index->capacity || index->tree == NULL)
+  {
+    double *tree = (double *)realloc(index->tree, sizeof(double) * (count + 1));
+    if (!tree)
+      return false;
+    index->tree = tree;
+
+    float *heights = (float *)realloc(index->heights, sizeof(float) * (count + 1));
+    if (!heights)
+      return false;
+    index->heights = heights;
+    index->capacity = count;
+  }
+
+  index->count = count;
+  index->top_bit = 1;
+  while (index->top_bit * 2 <= count)
+    index->top_bit *= 2;
+
+  // Linear build, each node pushes its sum to the one covering it
+  index->tree[0] = 0;
+  for (int i = 1; i <= count; i++)
+  {
+    index->heights[i - 1] = height;
+    index->tree[i] = height;
+  }
+  for (int i = 1; i <= count; i++)
+  {
+    int parent = i + (i & -i);
+    if (parent <= count)
+      index->tree[parent] += index->tree[i];
+  }
+  return true;
+}
+
+void offsets_set(offset_index_t *index, int item, float height)
+{
+  double delta = (double)height - index->heights[item];
+  if (delta == 0)
+    return;
+
+  index->heights[item] = height;
+  for (int i = item + 1; i <= index->count; i += i & -i)
+  {
+    index->tree[i] += delta;
+  }
+}
+
+float offsets_y(const offset_index_t *index, int item)
+{
+  double sum = 0;
+  for (int i = item; i > 0; i -= i & -i)
+  {
+    sum += index->tree[i];
+  }
+  return (float)sum;
+}
+
+float offsets_total(const offset_index_t *index)
+{
+  return offsets_y(index, index->count);
+}
+
+int offsets_find(const offset_index_t *index, float y)
+{
+  if (index->count == 0 || y <= 0)
+    return 0;
+
+  // Walk down from the largest span, taking every one that still ends at or
+  // before y. What's left is the number of items wholly above y.
+  int position = 0;
+  double remaining = y;
+  for (int step = index->top_bit; step > 0; step >>= 1)
+  {
+    if (position + step <= index->count && index->tree[position + step] <= remaining)
+    {
+      position += step;
+      remaining -= index->tree[position];
+    }
+  }
+  return position < index->count ? position : index->count - 1;
+}
@@ -0,0 +1,34 @@
+#ifndef OFFSETS_H
+#define OFFSETS_H
+
+#include <stdbool.h>
+
+// Heights of a list of items in a Fenwick tree, so the y of any item and the
+// item at any y are found in O(log n), and one height changes in O(log n).
+// Sums are kept in doubles so long lists don't drift.
+typedef struct offset_index
+{
+  double *tree;   // Fenwick tree over heights, 1-based
+  float *heights; // Height of each item
+  int count;
+  int capacity;
+  int top_bit; // Highest power of two not above count, for offsets_find
+} offset_index_t;
+
+offset_index_t *offsets_create(void);
+void offsets_destroy(offset_index_t *index);
+
+// Sets count items, all of the same height, in O(n)
+bool offsets_reset(offset_index_t *index, int count, float height);
+void offsets_set(offset_index_t *index, int item, float height);
+
+float offsets_y(const offset_index_t *index, int item); // Sum of heights before item
+int offsets_find(const offset_index_t *index, float y); // Item spanning y, clamped to the list
+float offsets_total(const offset_index_t *index);
+
+static inline float offsets_height(const offset_index_t *index, int item)
+{
+  return index->heights[item];
+}
+
+#endif // OFFSETS_H
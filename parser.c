@@ -3,14 +3,20 @@
 #include <string.h>
 #include <ctype.h>
 #include "parser.h"
+#include "tzcache.h"
 
 #define MAX_LINE_LENGTH 256
 
-static bool parse_time_range(const char *range_str, time_t *start, time_t *end, parse_error_t *error);
-static bool parse_schedule_line(const char *line, schedule_item_t *item, parse_error_t *error);
+static bool parse_time_range(const char *range_str, int date, time_t *start, time_t *end, parse_error_t *error);
+static bool parse_schedule_line(const char *line, int date, schedule_item_t *item, parse_error_t *error);
 static void trim(char *str);
 
 schedule_t *parse_schedule_file(const char *filename, parse_error_t *error)
+{
+  return parse_schedule_file_on(filename, date_today(), error);
+}
+
+schedule_t *parse_schedule_file_on(const char *filename, int date, parse_error_t *error)
 {
   FILE *file = fopen(filename, "r");
   if (!file)
@@ -28,6 +34,7 @@ schedule_t *parse_schedule_file(const char *filename, parse_error_t *error)
       *error = PARSE_ERROR_MEMORY;
     return NULL;
   }
+  schedule->date = date;
 
   char line[MAX_LINE_LENGTH];
   while (fgets(line, sizeof(line), file))
@@ -40,7 +47,7 @@ schedule_t *parse_schedule_file(const char *filename, parse_error_t *error)
     line[strcspn(line, "\n")] = 0;
 
     schedule_item_t item;
-    if (!parse_schedule_line(line, &item, error))
+    if (!parse_schedule_line(line, date, &item, error))
     {
       destroy_schedule(schedule);
       fclose(file);
@@ -56,6 +63,54 @@ schedule_t *parse_schedule_file(const char *filename, parse_error_t *error)
   return schedule;
 }
 
+// 12 hour clock, a bare "12:30" would be read back as half past midnight
+static void write_time(FILE *file, time_t time)
+{
+  int date, minute;
+  tzcache_split(time, &date, &minute);
+  int hour = minute / 60;
+  fprintf(file, "%d:%02d %s", hour % 12 == 0 ? 12 : hour % 12, minute % 60, hour < 12 ? "AM" : "PM");
+}
+
+bool write_schedule_file(const char *filename, const schedule_t *schedule)
+{
+  char *temp = malloc(strlen(filename) + 5);
+  if (!temp)
+    return false;
+  sprintf(temp, "%s.tmp", filename);
+
+  FILE *file = fopen(temp, "w");
+  if (!file)
+  {
+    free(temp);
+    return false;
+  }
+
+  for (int i = 0; i < schedule->count; i++)
+  {
+    const schedule_item_t *item = &schedule->items[i];
+    fprintf(file, "%s: ", item->title);
+    write_time(file, item->start);
+    fprintf(file, " - ");
+    write_time(file, item->end);
+    fprintf(file, ".\n");
+  }
+
+  bool written = !ferror(file);
+  written = fclose(file) == 0 && written;
+#ifdef _WIN32
+  // rename doesn't replace an existing file there
+  if (written)
+    remove(filename);
+#endif
+  if (written)
+    written = rename(temp, filename) == 0;
+  if (!written)
+    remove(temp);
+  free(temp);
+  return written;
+}
+
 const char *parse_error_to_string(parse_error_t error)
 {
   switch (error)
@@ -76,6 +131,11 @@ const char *parse_error_to_string(parse_error_t error)
 }
 
 time_t parse_time(const char *time_str, parse_error_t *error)
+{
+  return parse_time_on(time_str, date_today(), error);
+}
+
+time_t parse_time_on(const char *time_str, int date, parse_error_t *error)
 {
   char str[32];
   memset(str, 0, sizeof(str));
@@ -128,10 +188,10 @@ time_t parse_time(const char *time_str, parse_error_t *error)
     return (time_t)-1;
   }
 
-  return make_time(hour, minute);
+  return make_date_time(date, hour, minute);
 }
 
-static bool parse_time_range(const char *range_str, time_t *start, time_t *end, parse_error_t *error)
+static bool parse_time_range(const char *range_str, int date, time_t *start, time_t *end, parse_error_t *error)
 {
   char start_str[32];
   char end_str[32];
@@ -168,18 +228,18 @@ static bool parse_time_range(const char *range_str, time_t *start, time_t *end,
 
   strncpy(end_str, separator + 1, sizeof(end_str) - 1);
 
-  *start = parse_time(start_str, error);
+  *start = parse_time_on(start_str, date, error);
   if (*start == (time_t)-1)
     return false;
 
-  *end = parse_time(end_str, error);
+  *end = parse_time_on(end_str, date, error);
   if (*end == (time_t)-1)
     return false;
 
   return true;
 }
 
-static bool parse_schedule_line(const char *line, schedule_item_t *item, parse_error_t *error)
+static bool parse_schedule_line(const char *line, int date, schedule_item_t *item, parse_error_t *error)
 {
   char title[100];
   char time_range[64];
@@ -226,7 +286,7 @@ static bool parse_schedule_line(const char *line, schedule_item_t *item, parse_e
   trim(title);
 
   // Parse the time range
-  if (!parse_time_range(time_range, &item->start, &item->end, error))
+  if (!parse_time_range(time_range, date, &item->start, &item->end, error))
   {
     return false;
   }
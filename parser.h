@@ -17,10 +17,21 @@ typedef enum parse_error
 // Returns NULL if parsing fails
 schedule_t *parse_schedule_file(const char *filename, parse_error_t *error);
 
+// Same as parse_schedule_file, but resolves item times against the given date
+// instead of today
+schedule_t *parse_schedule_file_on(const char *filename, int date, parse_error_t *error);
+
+// Write a schedule's items to a file in the format parse_schedule_file reads,
+// one "Title: 9:00 AM - 10:00 AM." line per item. The file is written next
+// to filename and renamed over it, so a reader never sees half of it. Returns
+// false if it couldn't be written.
+bool write_schedule_file(const char *filename, const schedule_t *schedule);
+
 // Convert a parse error to a string
 const char *parse_error_to_string(parse_error_t error);
 
 // Helper function to parse a time string (exposed for testing)
 time_t parse_time(const char *time_str, parse_error_t *error);
+time_t parse_time_on(const char *time_str, int date, parse_error_t *error);
 
 #endif // PARSER_H
\ No newline at end of file
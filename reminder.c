@@ -0,0 +1,113 @@
+#include <stdlib.h>
+#include "reminder.h"
+
+static bool event_before(const reminder_event_t *a, const reminder_event_t *b)
+{
+  if (a->at != b->at)
+    return a->at < b->at;
+  return a->kind < b->kind;
+}
+
+static void sift_down(reminder_engine_t *engine, int i)
+{
+  reminder_event_t *heap = engine->heap;
+  for (;;)
+  {
+    int smallest = i;
+    int left = 2 * i + 1;
+    int right = left + 1;
+    if (left < engine->count && event_before(&heap[left], &heap[smallest]))
+      smallest = left;
+    if (right < engine->count && event_before(&heap[right], &heap[smallest]))
+      smallest = right;
+    if (smallest == i)
+      return;
+
+    reminder_event_t tmp = heap[i];
+    heap[i] = heap[smallest];
+    heap[smallest] = tmp;
+    i = smallest;
+  }
+}
+
+static void push_event(reminder_engine_t *engine, time_t at, int item, reminder_kind_t kind, time_t now)
+{
+  if (at <= now)
+    return; // Already happened
+
+  if (engine->count == engine->capacity)
+  {
+    engine->capacity = engine->capacity ? engine->capacity * 2 : 64;
+    engine->heap = (reminder_event_t *)realloc(engine->heap, sizeof(reminder_event_t) * engine->capacity);
+  }
+  engine->heap[engine->count++] = (reminder_event_t){at, item, kind};
+}
+
+reminder_engine_t *reminder_create(int lead, reminder_fn callback, void *user_data)
+{
+  reminder_engine_t *engine = (reminder_engine_t *)calloc(1, sizeof(reminder_engine_t));
+  if (!engine)
+    return NULL;
+
+  engine->lead = lead;
+  engine->callback = callback;
+  engine->user_data = user_data;
+  return engine;
+}
+
+void reminder_destroy(reminder_engine_t *engine)
+{
+  if (engine == NULL)
+    return;
+
+  free(engine->heap);
+  free(engine);
+}
+
+void reminder_load(reminder_engine_t *engine, const schedule_t *schedule, time_t now)
+{
+  engine->schedule = schedule;
+  engine->count = 0;
+
+  for (int i = 0; i < schedule->count; i++)
+  {
+    const schedule_item_t *item = &schedule->items[i];
+    push_event(engine, item->start, i, REMINDER_START, now);
+    push_event(engine, item->end, i, REMINDER_END, now);
+    if (engine->lead > 0)
+    {
+      push_event(engine, item->start - engine->lead, i, REMINDER_START_SOON, now);
+      if (item->end - engine->lead > item->start)
+        push_event(engine, item->end - engine->lead, i, REMINDER_END_SOON, now);
+    }
+  }
+
+  // Bottom-up heapify
+  for (int i = engine->count / 2 - 1; i >= 0; i--)
+  {
+    sift_down(engine, i);
+  }
+}
+
+int reminder_poll(reminder_engine_t *engine, time_t now)
+{
+  int fired = 0;
+  while (engine->count > 0 && engine->heap[0].at <= now)
+  {
+    reminder_event_t event = engine->heap[0];
+    engine->heap[0] = engine->heap[--engine->count];
+    sift_down(engine, 0);
+
+    if (event.item < engine->schedule->count && engine->callback)
+    {
+      engine->callback(&engine->schedule->items[event.item], event.kind, engine->user_data);
+    }
+    fired++;
+  }
+  return fired;
+}
+
+time_t reminder_next_deadline(reminder_engine_t *engine)
+{
+  return engine->count > 0 ? engine->heap[0].at : (time_t)-1;
+}
@@ -0,0 +1,51 @@
+#ifndef REMINDER_H
+#define REMINDER_H
+
+#include "data.h"
+
+// Order matters: events due at the same instant fire in this order, so an item
+// ending at 10:00 is reported before the next one starting at 10:00
+typedef enum reminder_kind
+{
+  REMINDER_END,        // Item just ended
+  REMINDER_START,      // Item just started
+  REMINDER_END_SOON,   // Lead time before the end
+  REMINDER_START_SOON, // Lead time before the start
+} reminder_kind_t;
+
+typedef void (*reminder_fn)(const schedule_item_t *item, reminder_kind_t kind, void *user_data);
+
+typedef struct reminder_event
+{
+  time_t at;
+  int item; // Index into the schedule
+  reminder_kind_t kind;
+} reminder_event_t;
+
+// Min-heap of upcoming start/end instants. Loading is O(n), finding the next
+// deadline is O(1) and firing an event is O(log n), so the main loop only
+// looks at items when one of them actually changes state.
+typedef struct reminder_engine
+{
+  reminder_event_t *heap;
+  int count;
+  int capacity;
+  const schedule_t *schedule;
+  int lead; // Seconds ahead of start/end for the *_SOON events, 0 for none
+  reminder_fn callback;
+  void *user_data;
+} reminder_engine_t;
+
+reminder_engine_t *reminder_create(int lead, reminder_fn callback, void *user_data);
+void reminder_destroy(reminder_engine_t *engine);
+
+// Replaces all pending events with the ones from schedule still ahead of now
+void reminder_load(reminder_engine_t *engine, const schedule_t *schedule, time_t now);
+
+// Fires every event due at or before now, returns how many fired
+int reminder_poll(reminder_engine_t *engine, time_t now);
+
+// Instant of the next event, or (time_t)-1 if there is none
+time_t reminder_next_deadline(reminder_engine_t *engine);
+
+#endif // REMINDER_H
@@ -7,6 +7,7 @@ static float scale_x = 1.0f;
 static float scale_y = 1.0f;
 static int base_width;
 static int base_height;
+static unsigned int epoch = 0;
 
 static scale_listener_t listeners[MAX_LISTENERS];
 static int listener_count = 0;
@@ -27,6 +28,7 @@ void scaling_update(void)
   {
     scale_x = new_scale_x;
     scale_y = new_scale_y;
+    epoch++;
 
     // Notify all listeners
     for (int i = 0; i < listener_count; i++)
@@ -46,6 +48,11 @@ float scaling_get_y(void)
   return scale_y;
 }
 
+unsigned int scaling_get_epoch(void)
+{
+  return epoch;
+}
+
 Vector2 scaling_apply(Vector2 vec)
 {
   return (Vector2){
@@ -15,6 +15,7 @@ void scaling_init(int base_width, int base_height);
 void scaling_update(void);
 float scaling_get_x(void);
 float scaling_get_y(void);
+unsigned int scaling_get_epoch(void); // Changes whenever the scale does
 Vector2 scaling_apply(Vector2 vec);
 float scaling_apply_x(float x);
 float scaling_apply_y(float y);
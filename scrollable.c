@@ -52,6 +52,27 @@ void destroy_scrollable(scrollable_t *scrollable)
   free(scrollable);
 }
 
+// Clips to the content and moves it by the scroll
+static void scrollable_enter(scrollable_t *scrollable)
+{
+  float handle_width = BASE_HANDLE_WIDTH;
+  float handle_padding = scaling_apply_x(BASE_HANDLE_PADDING);
+  BeginScissorMode(
+      scrollable->bounds.x,
+      scrollable->bounds.y,
+      scrollable->bounds.width - handle_width - (handle_padding * 2),
+      scrollable->bounds.height);
+
+  rlPushMatrix();
+  rlTranslatef(0, -scrollable->scroll_offset, 0);
+}
+
+static void scrollable_leave(scrollable_t *scrollable)
+{
+  rlPopMatrix();
+  EndScissorMode();
+}
+
 void begin_scrollable(scrollable_t *scrollable)
 {
   float handle_width = BASE_HANDLE_WIDTH;
@@ -102,17 +123,30 @@ void begin_scrollable(scrollable_t *scrollable)
   float max_scroll = fmaxf(0, scrollable->content_height - scrollable->bounds.height);
   scrollable->scroll_offset = Clamp(scrollable->scroll_offset, 0, max_scroll);
 
-  // Begin scissor mode and transform
-  BeginScissorMode(
+  scrollable_enter(scrollable);
+  scrollable->last_y_pos = 0;
+}
+
+void scrollable_suspend(scrollable_t *scrollable)
+{
+  scrollable_leave(scrollable);
+}
+
+void scrollable_resume(scrollable_t *scrollable)
+{
+  scrollable_enter(scrollable);
+}
+
+bool scrollable_contains(const scrollable_t *scrollable, Vector2 point)
+{
+  float handle_width = BASE_HANDLE_WIDTH;
+  float handle_padding = scaling_apply_x(BASE_HANDLE_PADDING);
+  Rectangle content = {
       scrollable->bounds.x,
       scrollable->bounds.y,
       scrollable->bounds.width - handle_width - (handle_padding * 2),
-      scrollable->bounds.height);
-
-  rlPushMatrix();
-  rlTranslatef(0, -scrollable->scroll_offset, 0);
-
-  scrollable->last_y_pos = 0;
+      scrollable->bounds.height};
+  return CheckCollisionPointRec(point, content);
 }
 
 void end_scrollable(scrollable_t *scrollable)
@@ -123,8 +157,7 @@ void end_scrollable(scrollable_t *scrollable)
 
   // Update content height and restore transform
   scrollable->content_height = scrollable->last_y_pos;
-  rlPopMatrix();
-  EndScissorMode();
+  scrollable_leave(scrollable);
 
   // Draw scrollbar if needed
   if (scrollable->content_height > scrollable->bounds.height)
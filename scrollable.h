@@ -18,5 +18,11 @@ scrollable_t *create_scrollable(Rectangle bounds);
 void destroy_scrollable(scrollable_t *scrollable);
 void begin_scrollable(scrollable_t *scrollable);
 void end_scrollable(scrollable_t *scrollable);
+// Steps out of the clip and scroll between begin_scrollable and
+// end_scrollable, to draw somewhere else halfway through, like a texture
+void scrollable_suspend(scrollable_t *scrollable);
+void scrollable_resume(scrollable_t *scrollable);
+// Whether point is on the visible content, not the scrollbar or outside
+bool scrollable_contains(const scrollable_t *scrollable, Vector2 point);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "search.h"
+
+#define SEARCH_INITIAL_SLOTS 1024
+#define SEARCH_EMPTY_SLOT UINT32_MAX
+
+static uint32_t trigram(const char *text)
+{
+  return ((uint32_t)(unsigned char)tolower((unsigned char)text[0]) << 16) |
+         ((uint32_t)(unsigned char)tolower((unsigned char)text[1]) << 8) |
+         (uint32_t)(unsigned char)tolower((unsigned char)text[2]);
+}
+
+static uint32_t slot_of(uint32_t key, int slots)
+{
+  return (key * 2654435761u) & (uint32_t)(slots - 1);
+}
+
+static int find_slot(search_index_t *index, uint32_t key)
+{
+  uint32_t slot = slot_of(key, index->slots);
+  while (index->keys[slot] != SEARCH_EMPTY_SLOT && index->keys[slot] != key)
+  {
+    slot = (slot + 1) & (uint32_t)(index->slots - 1);
+  }
+  return (int)slot;
+}
+
+static void search_alloc(search_index_t *index, int slots)
+{
+  index->slots = slots;
+  index->used = 0;
+  index->keys = (uint32_t *)malloc(sizeof(uint32_t) * slots);
+  index->postings = (search_postings_t *)calloc(slots, sizeof(search_postings_t));
+  memset(index->keys, 0xff, sizeof(uint32_t) * slots);
+}
+
+static void search_grow(search_index_t *index)
+{
+  uint32_t *keys = index->keys;
+  search_postings_t *postings = index->postings;
+  int slots = index->slots;
+
+  search_alloc(index, slots * 2);
+  for (int i = 0; i < slots; i++)
+  {
+    if (keys[i] == SEARCH_EMPTY_SLOT)
+      continue;
+    int slot = find_slot(index, keys[i]);
+    index->keys[slot] = keys[i];
+    index->postings[slot] = postings[i];
+    index->used++;
+  }
+  free(keys);
+  free(postings);
+}
+
+static void append_title(search_index_t *index, int item, const char *title, size_t length)
+{
+  if (item >= index->offset_capacity)
+  {
+    int capacity = index->offset_capacity ? index->offset_capacity : 64;
+    while (capacity <= item)
+      capacity *= 2;
+    index->offsets = (int *)realloc(index->offsets, sizeof(int) * capacity);
+    index->offset_capacity = capacity;
+  }
+
+  // Items skipped over get the empty string at the start of text
+  for (int i = index->item_count; i < item; i++)
+    index->offsets[i] = 0;
+
+  if (index->text_size + length + 1 > index->text_capacity)
+  {
+    size_t capacity = index->text_capacity ? index->text_capacity : 4096;
+    while (capacity < index->text_size + length + 1)
+      capacity *= 2;
+    index->text = (char *)realloc(index->text, capacity);
+    index->text_capacity = capacity;
+  }
+
+  index->offsets[item] = (int)index->text_size;
+  for (size_t i = 0; i < length; i++)
+    index->text[index->text_size++] = (char)tolower((unsigned char)title[i]);
+  index->text[index->text_size++] = '\0';
+}
+
+static void search_reset_query(search_index_t *index)
+{
+  index->query[0] = '\0';
+  index->result_count = -1; // No previous results to narrow down
+}
+
+search_index_t *search_create(void)
+{
+  search_index_t *index = (search_index_t *)calloc(1, sizeof(search_index_t));
+  if (!index)
+    return NULL;
+
+  search_alloc(index, SEARCH_INITIAL_SLOTS);
+  index->text = (char *)malloc(1);
+  index->text[0] = '\0';
+  index->text_size = 1;
+  index->text_capacity = 1;
+  search_reset_query(index);
+  return index;
+}
+
+static void search_clear(search_index_t *index)
+{
+  for (int i = 0; i < index->slots; i++)
+  {
+    free(index->postings[i].items);
+  }
+  free(index->keys);
+  free(index->postings);
+}
+
+void search_destroy(search_index_t *index)
+{
+  if (index == NULL)
+    return;
+
+  search_clear(index);
+  free(index->text);
+  free(index->offsets);
+  free(index->results);
+  free(index);
+}
+
+void search_add(search_index_t *index, int item, const char *title)
+{
+  size_t length = strlen(title);
+  append_title(index, item, title, length);
+  for (size_t i = 0; i + 3 <= length; i++)
+  {
+    if (index->used * 2 >= index->slots)
+      search_grow(index);
+
+    uint32_t key = trigram(title + i);
+    int slot = find_slot(index, key);
+    if (index->keys[slot] == SEARCH_EMPTY_SLOT)
+    {
+      index->keys[slot] = key;
+      index->used++;
+    }
+
+    search_postings_t *list = &index->postings[slot];
+    if (list->count > 0 && list->items[list->count - 1] == item)
+      continue; // Trigram repeats within the title
+
+    if (list->count == list->capacity)
+    {
+      list->capacity = list->capacity ? list->capacity * 2 : 4;
+      list->items = (int *)realloc(list->items, sizeof(int) * list->capacity);
+    }
+    list->items[list->count++] = item;
+  }
+
+  if (item + 1 > index->item_count)
+    index->item_count = item + 1;
+  search_reset_query(index);
+}
+
+void search_build(search_index_t *index, const schedule_t *schedule)
+{
+  search_clear(index);
+  search_alloc(index, SEARCH_INITIAL_SLOTS);
+  index->item_count = 0;
+  index->text_size = 1;
+  for (int i = 0; i < schedule->count; i++)
+  {
+    search_add(index, i, schedule->items[i].title);
+  }
+  search_reset_query(index);
+}
+
+// Position of the first entry of list at or past item
+static int postings_lower_bound(const search_postings_t *list, int item)
+{
+  int lo = 0;
+  int hi = list->count;
+  while (lo < hi)
+  {
+    int mid = (lo + hi) / 2;
+    if (list->items[mid] < item)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+void search_update(search_index_t *index, const schedule_t *schedule, int first)
+{
+  if (first <= 0)
+  {
+    search_build(index, schedule);
+    return;
+  }
+
+  // Postings are ascending, so dropping the items from first on cuts each
+  // list short. Trigrams left with no items keep their slot until the next
+  // build, lookups treat them as missing.
+  if (first < index->item_count)
+  {
+    for (int i = 0; i < index->slots; i++)
+    {
+      search_postings_t *list = &index->postings[i];
+      if (list->count > 0 && list->items[list->count - 1] >= first)
+        list->count = postings_lower_bound(list, first);
+    }
+    if (index->offsets[first] > 0)
+      index->text_size = index->offsets[first];
+    index->item_count = first;
+  }
+
+  for (int i = index->item_count; i < schedule->count; i++)
+  {
+    search_add(index, i, schedule->items[i].title);
+  }
+  search_reset_query(index);
+}
+
+// Both sides are lowercase already
+static bool title_matches(const char *title, const char *query, size_t length, bool prefix)
+{
+  if (prefix)
+    return strncmp(title, query, length) == 0;
+  return strstr(title, query) != NULL;
+}
+
+static void push_result(search_index_t *index, int item)
+{
+  if (index->result_count == index->result_capacity)
+  {
+    index->result_capacity = index->result_capacity ? index->result_capacity * 2 : 64;
+    index->results = (int *)realloc(index->results, sizeof(int) * index->result_capacity);
+  }
+  index->results[index->result_count++] = item;
+}
+
+// Keeps the candidates that appear in list, both ascending. Gallops through the
+// list since it is usually much longer than the candidates.
+static int intersect(int *candidates, int count, const search_postings_t *list)
+{
+  int kept = 0;
+  int at = 0;
+  for (int i = 0; i < count && at < list->count; i++)
+  {
+    int step = 1;
+    while (at + step < list->count && list->items[at + step] < candidates[i])
+      step *= 2;
+
+    int lo = at;
+    int hi = at + step < list->count ? at + step : list->count - 1;
+    while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+      if (list->items[mid] < candidates[i])
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    at = lo;
+    if (list->items[at] == candidates[i])
+      candidates[kept++] = candidates[i];
+  }
+  return kept;
+}
+
+int search_query(search_index_t *index, const char *query, bool prefix, const int **results)
+{
+  char lowered[SEARCH_MAX_QUERY];
+  size_t length = 0;
+  for (; query[length] && length < sizeof(lowered) - 1; length++)
+  {
+    lowered[length] = (char)tolower((unsigned char)query[length]);
+  }
+  lowered[length] = '\0';
+
+  // A query containing the previous one can only match a subset of its results
+  bool narrowing = index->result_count >= 0 &&
+                   prefix == index->prefix &&
+                   (prefix ? strncmp(lowered, index->query, strlen(index->query)) == 0
+                           : strstr(lowered, index->query) != NULL);
+
+  // Start from the rarest trigram, or the previous results if there are fewer
+  const search_postings_t *rarest = NULL;
+  bool found = true;
+  for (size_t i = 0; i + 3 <= length; i++)
+  {
+    int slot = find_slot(index, trigram(lowered + i));
+    const search_postings_t *list = &index->postings[slot];
+    if (index->keys[slot] == SEARCH_EMPTY_SLOT || list->count == 0)
+    {
+      found = false;
+      break;
+    }
+    if (rarest == NULL || list->count < rarest->count)
+      rarest = list;
+  }
+
+  int *candidates = NULL;
+  int count = 0;
+  if (!found)
+  {
+    count = 0;
+  }
+  else if (narrowing && (rarest == NULL || index->result_count <= rarest->count))
+  {
+    count = index->result_count;
+    candidates = (int *)malloc(sizeof(int) * (count + 1));
+    memcpy(candidates, index->results, sizeof(int) * count);
+  }
+  else if (rarest == NULL)
+  {
+    // Too short for trigrams, everything is a candidate
+    count = index->item_count;
+    candidates = (int *)malloc(sizeof(int) * (count + 1));
+    for (int i = 0; i < count; i++)
+      candidates[i] = i;
+  }
+  else
+  {
+    count = rarest->count;
+    candidates = (int *)malloc(sizeof(int) * count);
+    memcpy(candidates, rarest->items, sizeof(int) * count);
+    for (size_t i = 0; i + 3 <= length && count > 0; i++)
+    {
+      const search_postings_t *list = &index->postings[find_slot(index, trigram(lowered + i))];
+      if (list != rarest)
+        count = intersect(candidates, count, list);
+    }
+  }
+
+  // Trigrams don't say anything about order or position, check the titles
+  index->result_count = 0;
+  for (int i = 0; i < count; i++)
+  {
+    int item = candidates[i];
+    if (title_matches(index->text + index->offsets[item], lowered, length, prefix))
+      push_result(index, item);
+  }
+  free(candidates);
+
+  memcpy(index->query, lowered, length + 1);
+  index->prefix = prefix;
+  *results = index->results;
+  return index->result_count;
+}
@@ -0,0 +1,60 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdint.h>
+#include "data.h"
+
+#define SEARCH_MAX_QUERY 100
+
+// Items containing one trigram, in ascending item order
+typedef struct search_postings
+{
+  int *items;
+  int count;
+  int capacity;
+} search_postings_t;
+
+// Case-insensitive trigram index over item titles. A query is answered by
+// intersecting the postings of its trigrams and checking the survivors, so
+// cost follows the rarest trigram rather than the number of items. Queries
+// that extend the previous one (typing) only re-check the previous results.
+typedef struct search_index
+{
+  uint32_t *keys;             // Open addressing table of trigrams
+  search_postings_t *postings; // Postings per table slot
+  int slots;                  // Table size, a power of two
+  int used;                   // Occupied slots
+  int item_count;             // Items indexed so far
+
+  char *text;          // Lowercased titles, back to back
+  size_t text_size;
+  size_t text_capacity;
+  int *offsets;        // Start of each item's title in text
+  int offset_capacity;
+
+  char query[SEARCH_MAX_QUERY]; // Last query, lowercased
+  bool prefix;                  // Last query was a prefix query
+  int *results;                 // Matching item indices, ascending
+  int result_count;
+  int result_capacity;
+} search_index_t;
+
+search_index_t *search_create(void);
+void search_destroy(search_index_t *index);
+
+// Index one more title. Items must be added in ascending order.
+void search_add(search_index_t *index, int item, const char *title);
+
+// Drop everything and index all of a schedule's titles
+void search_build(search_index_t *index, const schedule_t *schedule);
+
+// Index the schedule's titles again from item first on, after an edit, undo or
+// reload changed the items from there down. The ones before first are kept,
+// only their postings past first are cut off. With first 0 this is a build.
+void search_update(search_index_t *index, const schedule_t *schedule, int first);
+
+// Finds items whose title contains query (or starts with it when prefix is
+// set). Results are valid until the next query or build.
+int search_query(search_index_t *index, const char *query, bool prefix, const int **results);
+
+#endif // SEARCH_H
@@ -0,0 +1,296 @@
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "textcache.h"
+#include "scaling.h"
+
+#define TEXT_CACHE_INITIAL_CAPACITY 256
+#define TEXT_ELLIPSIS "..."
+
+text_cache_t *text_cache_create(void)
+{
+  text_cache_t *cache = (text_cache_t *)malloc(sizeof(text_cache_t));
+  if (!cache)
+    return NULL;
+
+  cache->capacity = TEXT_CACHE_INITIAL_CAPACITY;
+  cache->entries = (text_entry_t *)calloc(cache->capacity, sizeof(text_entry_t));
+  cache->count = 0;
+  cache->scale_epoch = scaling_get_epoch();
+  return cache;
+}
+
+static void text_entry_free(text_entry_t *entry)
+{
+  free(entry->text); // Offsets and advances share its allocation
+  free(entry->lines);
+  free(entry->fitted);
+}
+
+static void text_cache_flush(text_cache_t *cache)
+{
+  for (int i = 0; i < cache->capacity; i++)
+  {
+    if (cache->entries[i].hash != 0)
+      text_entry_free(&cache->entries[i]);
+  }
+  memset(cache->entries, 0, sizeof(text_entry_t) * cache->capacity);
+  cache->count = 0;
+}
+
+void text_cache_destroy(text_cache_t *cache)
+{
+  if (cache == NULL)
+    return;
+
+  text_cache_flush(cache);
+  free(cache->entries);
+  free(cache);
+}
+
+//------------------------------------------------------------------------------
+// Lookup
+//------------------------------------------------------------------------------
+
+// FNV-1a over the bytes and the font size, never 0 so 0 can mark empty slots
+static uint32_t text_hash(const char *text, int length, int font_size)
+{
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < length; i++)
+  {
+    hash = (hash ^ (unsigned char)text[i]) * 16777619u;
+  }
+  hash = (hash ^ (uint32_t)font_size) * 16777619u;
+  return hash ? hash : 1;
+}
+
+static void text_cache_grow(text_cache_t *cache)
+{
+  text_entry_t *old = cache->entries;
+  int old_capacity = cache->capacity;
+  cache->capacity *= 2;
+  cache->entries = (text_entry_t *)calloc(cache->capacity, sizeof(text_entry_t));
+
+  for (int i = 0; i < old_capacity; i++)
+  {
+    if (old[i].hash == 0)
+      continue;
+    int slot = old[i].hash & (cache->capacity - 1);
+    while (cache->entries[slot].hash != 0)
+      slot = (slot + 1) & (cache->capacity - 1);
+    cache->entries[slot] = old[i];
+  }
+  free(old);
+}
+
+// Advance of one glyph of the default font, the way MeasureTextEx adds it up
+static float text_glyph_advance(Font font, int codepoint, float scale)
+{
+  int index = GetGlyphIndex(font, codepoint);
+  if (font.glyphs[index].advanceX != 0)
+    return font.glyphs[index].advanceX * scale;
+  return (font.recs[index].width + font.glyphs[index].offsetX) * scale;
+}
+
+static void text_entry_measure(text_entry_t *entry, const char *text, int length, int font_size)
+{
+  // One block for the text, the codepoint offsets and the pen positions
+  size_t text_size = (length + 1 + sizeof(int) - 1) / sizeof(int) * sizeof(int);
+  char *block = (char *)malloc(text_size + (sizeof(int) + sizeof(float)) * (length + 1));
+  entry->text = block;
+  entry->offsets = (int *)(block + text_size);
+  entry->advance = (float *)(entry->offsets + length + 1);
+  memcpy(entry->text, text, length);
+  entry->text[length] = '\0';
+  entry->length = length;
+  entry->font_size = font_size;
+
+  // DrawText's own sizing, see MeasureText
+  Font font = GetFontDefault();
+  int size = font_size < 10 ? 10 : font_size;
+  entry->spacing = size / 10;
+  float scale = (float)size / font.baseSize;
+
+  int glyphs = 0;
+  float pen = 0;
+  for (int i = 0; i < length;)
+  {
+    int bytes = 0;
+    int codepoint = GetCodepointNext(&text[i], &bytes);
+    entry->offsets[glyphs] = i;
+    entry->advance[glyphs] = pen;
+    pen += text_glyph_advance(font, codepoint, scale) + entry->spacing;
+    glyphs++;
+    i += bytes;
+  }
+  entry->offsets[glyphs] = length;
+  entry->advance[glyphs] = pen;
+  entry->glyphs = glyphs;
+  entry->width = glyphs > 0 ? pen - entry->spacing : 0;
+
+  entry->fit_width = -1;
+  entry->fit_lines = 0;
+  entry->lines = NULL;
+  entry->line_count = 0;
+  entry->fitted = NULL;
+}
+
+static text_entry_t *text_cache_get(text_cache_t *cache, const char *text, int font_size)
+{
+  // Everything was measured for the old scale
+  if (cache->scale_epoch != scaling_get_epoch())
+  {
+    text_cache_flush(cache);
+    cache->scale_epoch = scaling_get_epoch();
+  }
+
+  int length = strlen(text);
+  uint32_t hash = text_hash(text, length, font_size);
+  int slot = hash & (cache->capacity - 1);
+  while (cache->entries[slot].hash != 0)
+  {
+    text_entry_t *entry = &cache->entries[slot];
+    if (entry->hash == hash && entry->font_size == font_size && entry->length == length &&
+        memcmp(entry->text, text, length) == 0)
+      return entry;
+    slot = (slot + 1) & (cache->capacity - 1);
+  }
+
+  if (cache->count >= TEXT_CACHE_MAX_ENTRIES)
+  {
+    text_cache_flush(cache);
+    return text_cache_get(cache, text, font_size);
+  }
+  if ((cache->count + 1) * 4 > cache->capacity * 3)
+  {
+    text_cache_grow(cache);
+    return text_cache_get(cache, text, font_size);
+  }
+
+  text_entry_t *entry = &cache->entries[slot];
+  entry->hash = hash;
+  text_entry_measure(entry, text, length, font_size);
+  cache->count++;
+  return entry;
+}
+
+//------------------------------------------------------------------------------
+// Measuring and fitting
+//------------------------------------------------------------------------------
+
+float text_cache_width(text_cache_t *cache, const char *text, int font_size)
+{
+  return text_cache_get(cache, text, font_size)->width;
+}
+
+// Width of the glyphs from first up to end
+static float text_entry_span(const text_entry_t *entry, int first, int end)
+{
+  return end > first ? entry->advance[end] - entry->advance[first] - entry->spacing : 0;
+}
+
+// Furthest end such that the glyphs from first up to it fit in width, by
+// binary search over the pen positions. Returns first when none do.
+static int text_entry_reach(const text_entry_t *entry, int first, float width)
+{
+  int lo = first;
+  int hi = entry->glyphs;
+  while (lo < hi)
+  {
+    int mid = lo + (hi - lo + 1) / 2;
+    if (text_entry_span(entry, first, mid) <= width)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  return lo;
+}
+
+static bool text_entry_is_space(const text_entry_t *entry, int glyph)
+{
+  return entry->text[entry->offsets[glyph]] == ' ';
+}
+
+// Breaks the entry into lines for width and max_lines, cutting the last one
+// short with an ellipsis when text is left over
+static void text_entry_fit(text_entry_t *entry, float width, int max_lines, float ellipsis_width)
+{
+  entry->lines = (int *)realloc(entry->lines, sizeof(int) * 2 * max_lines);
+  entry->line_count = 0;
+
+  int first = 0;
+  while (first < entry->glyphs && entry->line_count < max_lines)
+  {
+    int end = text_entry_reach(entry, first, width);
+    if (end == first)
+      end = first + 1; // Not even a glyph fits, overflow rather than loop
+    if (end < entry->glyphs && entry->line_count + 1 < max_lines)
+    {
+      // Back off to the last space, unless the word fills the line
+      int space = end;
+      while (space > first && !text_entry_is_space(entry, space))
+        space--;
+      if (space > first)
+        end = space;
+    }
+
+    entry->lines[2 * entry->line_count] = first;
+    entry->lines[2 * entry->line_count + 1] = end;
+    entry->line_count++;
+
+    first = end;
+    while (first < entry->glyphs && text_entry_is_space(entry, first))
+      first++;
+  }
+
+  bool truncated = first < entry->glyphs;
+  if (truncated)
+  {
+    // Room for the ellipsis and the spacing before it
+    int *last = &entry->lines[2 * (entry->line_count - 1)];
+    last[1] = text_entry_reach(entry, last[0], width - ellipsis_width - entry->spacing);
+  }
+
+  // Text of each line joined with newlines, which DrawText breaks on
+  int size = entry->length + entry->line_count + sizeof(TEXT_ELLIPSIS);
+  entry->fitted = (char *)realloc(entry->fitted, size);
+  char *out = entry->fitted;
+  for (int i = 0; i < entry->line_count; i++)
+  {
+    int line_first = entry->lines[2 * i];
+    int line_end = entry->lines[2 * i + 1];
+    while (line_end > line_first && text_entry_is_space(entry, line_end - 1))
+      line_end--;
+
+    int bytes = entry->offsets[line_end] - entry->offsets[line_first];
+    memcpy(out, entry->text + entry->offsets[line_first], bytes);
+    out += bytes;
+    if (i + 1 < entry->line_count)
+      *out++ = '\n';
+  }
+  if (truncated)
+  {
+    memcpy(out, TEXT_ELLIPSIS, sizeof(TEXT_ELLIPSIS) - 1);
+    out += sizeof(TEXT_ELLIPSIS) - 1;
+  }
+  *out = '\0';
+
+  entry->fit_width = width;
+  entry->fit_lines = max_lines;
+}
+
+const char *text_cache_fit(text_cache_t *cache, const char *text, int font_size, float max_width, int max_lines)
+{
+  if (max_lines < 1)
+    max_lines = 1;
+
+  // The ellipsis first, looking it up can move entries around
+  float ellipsis_width = text_cache_width(cache, TEXT_ELLIPSIS, font_size);
+  text_entry_t *entry = text_cache_get(cache, text, font_size);
+  if (entry->width <= max_width)
+    return entry->text;
+
+  if (entry->fit_width != max_width || entry->fit_lines != max_lines)
+    text_entry_fit(entry, max_width, max_lines, ellipsis_width);
+  return entry->fitted;
+}
@@ -0,0 +1,51 @@
+#ifndef TEXTCACHE_H
+#define TEXTCACHE_H
+
+#include <stdint.h>
+
+#define TEXT_CACHE_MAX_ENTRIES 4096 // Flushed past this, typed search text adds up
+
+// One string at one font size, with the pen position before every glyph so
+// the width of any run of it is a subtraction
+typedef struct text_entry
+{
+  uint32_t hash; // 0 for an empty slot
+  int font_size;
+  int length;     // Bytes of text
+  int glyphs;     // Codepoints in text
+  char *text;     // Copy of the key
+  int *offsets;   // Byte offset of each codepoint, glyphs + 1 of them
+  float *advance; // Pen position before each codepoint, glyphs + 1 of them
+  float spacing;  // Added after every glyph, taken off the last one
+  float width;
+
+  // Last fit asked for, the same box comes back every frame
+  float fit_width;
+  int fit_lines;
+  int *lines; // First and end codepoint of each line, in pairs
+  int line_count;
+  char *fitted; // Text with the line breaks and ellipsis put in
+} text_entry_t;
+
+// Widths and line breaks of the default font, keyed by string and font size.
+// Everything is measured once and kept until the scale epoch changes.
+typedef struct text_cache
+{
+  text_entry_t *entries;
+  int capacity; // Power of two, open addressing
+  int count;
+  unsigned int scale_epoch; // Scale the entries were measured at
+} text_cache_t;
+
+text_cache_t *text_cache_create(void);
+void text_cache_destroy(text_cache_t *cache);
+
+// Width of text drawn with DrawText at font_size, as MeasureText gives it
+float text_cache_width(text_cache_t *cache, const char *text, int font_size);
+
+// Text broken at spaces into at most max_lines lines of max_width, with what
+// doesn't fit cut off with an ellipsis found by binary search over the glyph
+// positions. Returns a string ready for DrawText, valid until the next call.
+const char *text_cache_fit(text_cache_t *cache, const char *text, int font_size, float max_width, int max_lines);
+
+#endif // TEXTCACHE_H
@@ -0,0 +1,122 @@
+#include <stdlib.h>
+#include "raylib.h"
+#include "rlgl.h"
+#include "tilecache.h"
+
+tile_cache_t *tile_cache_create(void)
+{
+  tile_cache_t *cache = (tile_cache_t *)calloc(1, sizeof(tile_cache_t));
+  if (!cache)
+    return NULL;
+
+  for (int i = 0; i < TILE_CACHE_TILES; i++)
+  {
+    cache->tiles[i].index = -1;
+  }
+  cache->generation = 1;
+  return cache;
+}
+
+static void tile_cache_unload(tile_cache_t *cache)
+{
+  for (int i = 0; i < TILE_CACHE_TILES; i++)
+  {
+    if (cache->tiles[i].target.id != 0)
+      UnloadRenderTexture(cache->tiles[i].target);
+    cache->tiles[i].target = (RenderTexture2D){0};
+    cache->tiles[i].index = -1;
+  }
+}
+
+void tile_cache_destroy(tile_cache_t *cache)
+{
+  if (cache == NULL)
+    return;
+
+  tile_cache_unload(cache);
+  free(cache);
+}
+
+void tile_cache_invalidate(tile_cache_t *cache)
+{
+  cache->generation++;
+}
+
+void tile_cache_drop_from(tile_cache_t *cache, float y)
+{
+  for (int i = 0; i < TILE_CACHE_TILES; i++)
+  {
+    tile_t *tile = &cache->tiles[i];
+    if (tile->index >= 0 && (float)(tile->index + 1) * cache->height > y)
+      tile->index = -1;
+  }
+}
+
+void tile_cache_resize(tile_cache_t *cache, int width, int viewport_height)
+{
+  // Half the viewport keeps it to three tiles on screen however it scrolls
+  int height = (viewport_height + 1) / 2;
+  if (height < TILE_MIN_HEIGHT)
+    height = TILE_MIN_HEIGHT;
+  cache->frame++;
+
+  if (width != cache->width || height != cache->height)
+  {
+    tile_cache_unload(cache); // Textures are loaded again at the new size
+    cache->width = width;
+    cache->height = height;
+    tile_cache_invalidate(cache);
+  }
+}
+
+tile_t *tile_cache_find(tile_cache_t *cache, int index)
+{
+  for (int i = 0; i < TILE_CACHE_TILES; i++)
+  {
+    tile_t *tile = &cache->tiles[i];
+    if (tile->index == index && tile->generation == cache->generation)
+      return tile;
+  }
+  return NULL;
+}
+
+tile_t *tile_cache_get(tile_cache_t *cache, int index, bool *fresh)
+{
+  tile_t *tile = tile_cache_find(cache, index);
+  *fresh = tile == NULL;
+  if (!tile)
+  {
+    // Reuse a tile of an older generation first, then the least recently used
+    tile = &cache->tiles[0];
+    for (int i = 1; i < TILE_CACHE_TILES && tile->generation == cache->generation; i++)
+    {
+      tile_t *candidate = &cache->tiles[i];
+      if (candidate->generation != cache->generation || candidate->used < tile->used)
+        tile = candidate;
+    }
+    if (tile->target.id == 0)
+      tile->target = LoadRenderTexture(cache->width, cache->height);
+    tile->index = index;
+    tile->generation = cache->generation;
+  }
+  tile->used = cache->frame;
+  return tile;
+}
+
+void tile_cache_begin(const tile_cache_t *cache, const tile_t *tile)
+{
+  BeginTextureMode(tile->target);
+  rlTranslatef(0, -(float)tile->index * cache->height, 0);
+}
+
+void tile_cache_end(void)
+{
+  EndTextureMode();
+}
+
+void tile_cache_draw(const tile_cache_t *cache, const tile_t *tile, float x)
+{
+  // Render textures are stored bottom up
+  Rectangle source = {0, 0, cache->width, -cache->height};
+  DrawTextureRec(tile->target.texture, source, (Vector2){x, (float)tile->index * cache->height}, WHITE);
+}
@@ -0,0 +1,60 @@
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <stdbool.h>
+#include "raylib.h"
+
+#define TILE_CACHE_TILES 6 // Tiles kept at once, a screen needs at most three
+#define TILE_MIN_HEIGHT 256
+
+// One band of scrolled content rendered into a texture
+typedef struct tile
+{
+  RenderTexture2D target;
+  int index;               // Band held, content y from index * height, or -1
+  unsigned int generation; // Cache generation it was drawn in
+  unsigned long used;      // Frame it was last asked for
+} tile_t;
+
+// Scrolled content kept as bands of pixels, so a frame where little changed
+// composites the bands instead of drawing the content again. The owner draws
+// into a band with tile_cache_begin and tile_cache_end when it's fresh, or
+// over the parts of it that changed.
+typedef struct tile_cache
+{
+  tile_t tiles[TILE_CACHE_TILES];
+  int width;
+  int height;              // Of every tile, half the viewport or more
+  unsigned int generation; // Tiles drawn in an older one are fresh again
+  unsigned long frame;
+} tile_cache_t;
+
+tile_cache_t *tile_cache_create(void);
+void tile_cache_destroy(tile_cache_t *cache);
+
+// Throws away what every tile holds, for when everything drawn changed
+void tile_cache_invalidate(tile_cache_t *cache);
+
+// Throws away the tiles reaching below content y, for when what's drawn from
+// there down changed and everything above it didn't
+void tile_cache_drop_from(tile_cache_t *cache, float y);
+
+// Sizes the tiles for a viewport, invalidating them when that changes their
+// size. Call once per frame before asking for tiles.
+void tile_cache_resize(tile_cache_t *cache, int width, int viewport_height);
+
+// Tile for a band, fresh when it holds nothing usable and must be drawn in
+// full. Reuses the tile unused the longest, never one asked for this frame.
+tile_t *tile_cache_get(tile_cache_t *cache, int index, bool *fresh);
+
+// Tile holding a band, or NULL when it isn't kept
+tile_t *tile_cache_find(tile_cache_t *cache, int index);
+
+// Draws into a tile in content coordinates, as if it were the screen
+void tile_cache_begin(const tile_cache_t *cache, const tile_t *tile);
+void tile_cache_end(void);
+
+// Band of a tile on screen at its content position
+void tile_cache_draw(const tile_cache_t *cache, const tile_t *tile, float x);
+
+#endif // TILECACHE_H
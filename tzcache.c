@@ -0,0 +1,274 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "data.h"
+#include "tzcache.h"
+
+#ifdef _WIN32
+#define _CRT_SECURE_NO_WARNINGS // No warnings about localtime_s
+#endif
+
+#define SECONDS_PER_DAY 86400
+#define TZCACHE_WINDOW_DAYS 366
+#define TZCACHE_MAX_TRANSITIONS 32
+
+typedef struct tzcache
+{
+  char tz[128];        // TZ variable the table was built for
+  time_t window_start; // Conversions inside [start, end) use the table
+  time_t window_end;
+  time_t next_midnight;
+  int today;
+  int count;
+  time_t at[TZCACHE_MAX_TRANSITIONS];   // Offset changes, at[0] is window_start
+  long offset[TZCACHE_MAX_TRANSITIONS]; // Offset in effect from at[i]
+} tzcache_t;
+
+// Tables are double buffered: a rebuild fills the one not in use and then
+// publishes it, so threads converting times (the prefetcher) never see a half
+// built table. Each conversion holds a reader count on the table it uses, and
+// a rebuild waits for the spare table's count to drop before writing over it.
+static tzcache_t tables[2];
+static atomic_int readers[2];
+static _Atomic(tzcache_t *) current;
+static pthread_mutex_t build_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static long floor_div(long long a, long b)
+{
+  return (long)(a >= 0 ? a / b : -((-a + b - 1) / b));
+}
+
+// Offset from libc, computed from the broken down time so it doesn't rely on
+// tm_gmtoff
+static long libc_offset(time_t t)
+{
+  struct tm tm;
+#ifdef _WIN32
+  localtime_s(&tm, &t);
+#else
+  localtime_r(&t, &tm);
+#endif
+  long long local = (long long)date_from_ymd(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday) * SECONDS_PER_DAY +
+                    tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec;
+  return (long)(local - t);
+}
+
+static time_t libc_make(int date, int minute)
+{
+  struct tm tm = {0};
+  int year, month, mday;
+  date_to_ymd(date, &year, &month, &mday);
+  tm.tm_year = year - 1900;
+  tm.tm_mon = month - 1;
+  tm.tm_mday = mday;
+  tm.tm_hour = minute / 60;
+  tm.tm_min = minute % 60;
+  tm.tm_isdst = -1; // Let mktime work out DST for that day
+  return mktime(&tm);
+}
+
+static const char *current_tz(void)
+{
+  const char *tz = getenv("TZ");
+  return tz ? tz : "";
+}
+
+static bool needs_rebuild(const tzcache_t *cache, time_t now)
+{
+  return cache == NULL || now >= cache->next_midnight || strcmp(cache->tz, current_tz()) != 0;
+}
+
+static long offset_in(const tzcache_t *cache, time_t t)
+{
+  if (t < cache->window_start || t >= cache->window_end)
+  {
+    return libc_offset(t);
+  }
+
+  // A handful of entries at most, scan from the back
+  int i = cache->count - 1;
+  while (i > 0 && cache->at[i] > t)
+  {
+    i--;
+  }
+  return cache->offset[i];
+}
+
+static time_t make_in(const tzcache_t *cache, int date, int minute)
+{
+  long long local = (long long)date * SECONDS_PER_DAY + (long long)minute * 60;
+
+  if (local - cache->offset[0] < cache->window_start || local - cache->offset[cache->count - 1] >= cache->window_end)
+  {
+    return libc_make(date, minute);
+  }
+
+  // Try the offsets in effect a day either side. When both fit the local time
+  // is ambiguous (clocks went back) and the earlier instant wins; when neither
+  // does it sits in a DST gap and the offset from before the gap pushes it past
+  // the transition, like mktime.
+  long before = offset_in(cache, (time_t)(local - SECONDS_PER_DAY));
+  long after = offset_in(cache, (time_t)(local + SECONDS_PER_DAY));
+  time_t early = (time_t)(local - before);
+  time_t late = (time_t)(local - after);
+  bool early_fits = early + offset_in(cache, early) == local;
+  bool late_fits = late + offset_in(cache, late) == local;
+  if (late_fits && (!early_fits || late < early))
+    return late;
+  return early;
+}
+
+static void tzcache_build(time_t now)
+{
+  pthread_mutex_lock(&build_lock);
+
+  // Someone else may have rebuilt while we waited. Only the builder writes a
+  // table, so holding build_lock is enough to read the active one.
+  tzcache_t *active = atomic_load(&current);
+  if (!needs_rebuild(active, now))
+  {
+    pthread_mutex_unlock(&build_lock);
+    return;
+  }
+
+  tzset();
+
+  // Readers of the spare table are finishing a conversion that started before
+  // the last rebuild, a few hundred nanoseconds at most
+  tzcache_t *cache = active == &tables[0] ? &tables[1] : &tables[0];
+  while (atomic_load(&readers[cache - tables]) > 0)
+  {
+    sched_yield();
+  }
+
+  strncpy(cache->tz, current_tz(), sizeof(cache->tz) - 1);
+  cache->tz[sizeof(cache->tz) - 1] = '\0';
+  cache->window_start = now - (time_t)TZCACHE_WINDOW_DAYS * SECONDS_PER_DAY;
+  cache->window_end = now + (time_t)TZCACHE_WINDOW_DAYS * SECONDS_PER_DAY;
+  cache->at[0] = cache->window_start;
+  cache->offset[0] = libc_offset(cache->window_start);
+  cache->count = 1;
+
+  // Sample once a day and bisect down to the second wherever the offset moved.
+  // Zones never change offset twice within a day.
+  long previous = cache->offset[0];
+  for (time_t t = cache->window_start + SECONDS_PER_DAY; t < cache->window_end; t += SECONDS_PER_DAY)
+  {
+    long offset = libc_offset(t);
+    if (offset == previous)
+      continue;
+
+    time_t lo = t - SECONDS_PER_DAY;
+    time_t hi = t;
+    while (hi - lo > 1)
+    {
+      time_t mid = lo + (hi - lo) / 2;
+      if (libc_offset(mid) == previous)
+        lo = mid;
+      else
+        hi = mid;
+    }
+
+    if (cache->count == TZCACHE_MAX_TRANSITIONS)
+    {
+      cache->window_end = hi;
+      break;
+    }
+    cache->at[cache->count] = hi;
+    cache->offset[cache->count] = offset;
+    cache->count++;
+    previous = offset;
+  }
+
+  cache->today = floor_div((long long)now + offset_in(cache, now), SECONDS_PER_DAY);
+  cache->next_midnight = make_in(cache, cache->today + 1, 0);
+
+  atomic_store(&current, cache);
+  pthread_mutex_unlock(&build_lock);
+}
+
+// Take a reader count on the current table. The count is only good if the
+// table is still current after taking it, otherwise a rebuild may already be
+// writing over it and we go again.
+static const tzcache_t *tzcache_acquire(void)
+{
+  for (;;)
+  {
+    tzcache_t *cache = atomic_load(&current);
+    if (cache == NULL)
+    {
+      tzcache_build(time(NULL));
+      continue;
+    }
+
+    atomic_fetch_add(&readers[cache - tables], 1);
+    if (atomic_load(&current) == cache)
+      return cache;
+    atomic_fetch_sub(&readers[cache - tables], 1);
+  }
+}
+
+static void tzcache_release(const tzcache_t *cache)
+{
+  atomic_fetch_sub(&readers[cache - tables], 1);
+}
+
+void tzcache_refresh(time_t now)
+{
+  const tzcache_t *cache = tzcache_acquire();
+  bool stale = needs_rebuild(cache, now);
+  tzcache_release(cache);
+  if (stale)
+  {
+    tzcache_build(now);
+  }
+}
+
+int tzcache_today(void)
+{
+  time_t now = time(NULL);
+  const tzcache_t *cache = tzcache_acquire();
+  if (now >= cache->next_midnight)
+  {
+    tzcache_release(cache);
+    tzcache_build(now);
+    cache = tzcache_acquire();
+  }
+  int today = cache->today;
+  tzcache_release(cache);
+  return today;
+}
+
+long tzcache_offset(time_t t)
+{
+  const tzcache_t *cache = tzcache_acquire();
+  long offset = offset_in(cache, t);
+  tzcache_release(cache);
+  return offset;
+}
+
+int tzcache_date(time_t t)
+{
+  return floor_div((long long)t + tzcache_offset(t), SECONDS_PER_DAY);
+}
+
+void tzcache_split(time_t t, int *date, int *minute)
+{
+  long long local = (long long)t + tzcache_offset(t);
+  int day = floor_div(local, SECONDS_PER_DAY);
+  if (date)
+    *date = day;
+  if (minute)
+    *minute = (int)((local - (long long)day * SECONDS_PER_DAY) / 60);
+}
+
+time_t tzcache_make(int date, int minute)
+{
+  const tzcache_t *cache = tzcache_acquire();
+  time_t t = make_in(cache, date, minute);
+  tzcache_release(cache);
+  return t;
+}
@@ -0,0 +1,25 @@
+#ifndef TZCACHE_H
+#define TZCACHE_H
+
+#include <time.h>
+
+// Per-process cache of the local zone. The UTC offset and every DST transition
+// within a year either side of today are worked out once; converting between
+// time_t and (date, minute of day) is then plain arithmetic instead of a trip
+// through localtime_r/mktime and glibc's timezone lock.
+//
+// The table is rebuilt when the day rolls over or the TZ variable changes.
+// Times outside the cached window fall back to the libc functions. Safe to use
+// from several threads.
+
+// Rebuild the table if now is past midnight or the zone changed. Cheap enough
+// to call once per frame.
+void tzcache_refresh(time_t now);
+
+int tzcache_today(void);
+long tzcache_offset(time_t t);
+int tzcache_date(time_t t);
+void tzcache_split(time_t t, int *date, int *minute);
+time_t tzcache_make(int date, int minute);
+
+#endif // TZCACHE_H
@@ -0,0 +1,548 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "raylib.h"
+#include "wall.h"
+#include "scaling.h"
+
+#define WALL_COLUMN_WIDTH 180 // Width of one room
+#define WALL_HOUR_HEIGHT 120  // Height of an hour of the day
+#define WALL_GUTTER 60        // Time labels down the left edge
+#define WALL_HEADER 30        // Room names along the top
+#define WALL_CELL_PADDING 4
+#define WALL_FONT_SIZE 16
+#define WALL_SMALL_FONT_SIZE 13
+#define WALL_SCROLL_STEP 50
+#define WALL_PREFETCH_THREADS 4 // Rooms read in the background at once
+
+#define WALL_LINE \
+  (Color) { 220, 220, 220, 255 }
+#define WALL_EVENT \
+  (Color) { 245, 235, 255, 255 }
+#define WALL_BREAK \
+  (Color) { 235, 240, 255, 255 }
+
+static int wall_column_compare(const void *a, const void *b)
+{
+  return strcmp(((const wall_column_t *)a)->name, ((const wall_column_t *)b)->name);
+}
+
+wall_t *wall_create(const char *folder)
+{
+  FilePathList paths = LoadDirectoryFiles(folder);
+  wall_t *wall = (wall_t *)malloc(sizeof(wall_t));
+  wall->columns = (wall_column_t *)calloc(paths.count > 0 ? paths.count : 1, sizeof(wall_column_t));
+  wall->count = 0;
+  wall->date = 0;
+  wall->scroll_x = 0;
+  wall->scroll_y = 0;
+  wall->dragging = false;
+  wall->drag_last = (Vector2){0, 0};
+  wall->text = text_cache_create();
+  wall->prefetch_date = 0;
+  wall->prefetch_next = 0;
+  wall->hover_column = -1;
+  wall->hover_item = -1;
+  wall->selected_column = -1;
+  wall->selected_item = -1;
+
+  for (unsigned int i = 0; i < paths.count; i++)
+  {
+    if (IsPathFile(paths.paths[i]))
+      continue;
+
+    wall_column_t *column = &wall->columns[wall->count];
+    column->calendar = calendar_create(paths.paths[i]);
+    if (!column->calendar)
+      continue;
+    snprintf(column->name, sizeof(column->name), "%s", GetFileName(paths.paths[i]));
+    wall->count++;
+  }
+  UnloadDirectoryFiles(paths);
+
+  if (wall->count == 0)
+  {
+    wall_destroy(wall);
+    return NULL;
+  }
+
+  qsort(wall->columns, wall->count, sizeof(wall_column_t), wall_column_compare);
+  return wall;
+}
+
+void wall_destroy(wall_t *wall)
+{
+  if (wall == NULL)
+    return;
+
+  for (int i = 0; i < wall->count; i++)
+  {
+    calendar_destroy(wall->columns[i].calendar);
+    free(wall->columns[i].order);
+    free(wall->columns[i].reach);
+  }
+  text_cache_destroy(wall->text);
+  free(wall->columns);
+  free(wall);
+}
+
+void wall_show_day(wall_t *wall, int date)
+{
+  int previous = wall->date;
+  bool pending = false;
+  wall->date = date;
+  wall->hover_column = -1;
+  wall->selected_column = -1;
+  for (int i = 0; i < wall->count; i++)
+  {
+    wall_column_t *column = &wall->columns[i];
+    column->schedule = NULL;
+    column->indexed = false;
+    column->pending = !calendar_day_loaded(column->calendar, date);
+    if (!column->pending)
+    {
+      parse_error_t error;
+      column->schedule = calendar_get_day(column->calendar, date, &error);
+      if (!column->schedule && error != PARSE_ERROR_FILE_NOT_FOUND)
+        TraceLog(LOG_WARNING, "%s: %s", column->name, parse_error_to_string(error));
+    }
+    pending = pending || column->pending;
+
+    // Only the day on the wall is kept, 200 rooms of a week add up
+    if (previous != 0 && previous != date)
+      calendar_unload_day(column->calendar, previous);
+  }
+
+  // Reading 200 rooms here would stall the frame, they come in from wall_poll
+  if (pending)
+  {
+    wall->prefetch_date = date;
+    wall->prefetch_next = 0;
+  }
+}
+
+void wall_prefetch_day(wall_t *wall, int date)
+{
+  if (wall->prefetch_date == date)
+    return;
+
+  wall->prefetch_date = date;
+  wall->prefetch_next = 0;
+}
+
+bool wall_poll(wall_t *wall)
+{
+  int active = 0;
+  bool pending = false;
+  for (int i = 0; i < wall->count; i++)
+  {
+    wall_column_t *column = &wall->columns[i];
+    calendar_poll(column->calendar);
+    if (column->pending && calendar_day_loaded(column->calendar, wall->date))
+    {
+      parse_error_t error;
+      column->schedule = calendar_get_day(column->calendar, wall->date, &error);
+      if (!column->schedule && error != PARSE_ERROR_FILE_NOT_FOUND)
+        TraceLog(LOG_WARNING, "%s: %s", column->name, parse_error_to_string(error));
+      column->pending = false;
+      column->indexed = false;
+    }
+    if (column->calendar->prefetch.active)
+      active++;
+    pending = pending || column->pending;
+  }
+
+  while (wall->prefetch_next < wall->count && active < WALL_PREFETCH_THREADS)
+  {
+    wall_column_t *column = &wall->columns[wall->prefetch_next];
+    if (column->calendar->prefetch.active)
+      break; // Still reading another day, wait for it
+
+    if (calendar_prefetch_day(column->calendar, wall->prefetch_date))
+    {
+      active++;
+    }
+    else if (column->pending && wall->prefetch_date == wall->date)
+    {
+      // No thread to read it on, don't leave the room empty
+      column->schedule = calendar_get_day(column->calendar, wall->date, NULL);
+      column->pending = false;
+      column->indexed = false;
+    }
+    wall->prefetch_next++;
+  }
+
+  return pending || active > 0;
+}
+
+void wall_reload(wall_t *wall)
+{
+  for (int i = 0; i < wall->count; i++)
+  {
+    wall_column_t *column = &wall->columns[i];
+    parse_error_t error;
+    diff_t *changes = calendar_reload_day(column->calendar, wall->date, &error);
+    if (!changes)
+      continue;
+
+    if (!column->schedule)
+      column->schedule = calendar_get_day(column->calendar, wall->date, &error);
+    if (wall->selected_column == i)
+      wall->selected_column = -1; // Its item index may be another item now
+    TraceLog(LOG_INFO, "Reloaded %s: %d changes", column->name, changes->count);
+    diff_destroy(changes);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Culling
+//------------------------------------------------------------------------------
+
+// Items of the column being sorted, qsort has no way to pass them along.
+// Columns are only indexed from the main loop.
+static const schedule_item_t *wall_sort_items;
+
+// By start, then by position in the file so equal starts keep their order
+static int wall_order_compare(const void *a, const void *b)
+{
+  int left = *(const int *)a;
+  int right = *(const int *)b;
+  time_t left_start = wall_sort_items[left].start;
+  time_t right_start = wall_sort_items[right].start;
+  if (left_start != right_start)
+    return left_start < right_start ? -1 : 1;
+  return left - right;
+}
+
+// Sorts the column's items by start and gathers how far the items so far
+// reach, when the schedule changed since the last time
+static void wall_column_index(wall_column_t *column)
+{
+  schedule_t *schedule = column->schedule;
+  if (!schedule)
+  {
+    column->count = 0;
+    return;
+  }
+  if (column->indexed && column->version == schedule->version)
+    return;
+
+  if (schedule->count > column->capacity)
+  {
+    column->capacity = schedule->count;
+    column->order = (int *)realloc(column->order, sizeof(int) * column->capacity);
+    column->reach = (time_t *)realloc(column->reach, sizeof(time_t) * column->capacity);
+  }
+  column->count = schedule->count;
+
+  for (int i = 0; i < column->count; i++)
+  {
+    column->order[i] = i;
+  }
+  wall_sort_items = schedule->items;
+  qsort(column->order, column->count, sizeof(int), wall_order_compare);
+  wall_sort_items = NULL;
+
+  time_t reach = 0;
+  for (int i = 0; i < column->count; i++)
+  {
+    time_t end = schedule->items[column->order[i]].end;
+    if (end > reach)
+      reach = end;
+    column->reach[i] = reach;
+  }
+
+  column->indexed = true;
+  column->version = schedule->version;
+}
+
+// First item in start order that could still be on screen at time, the
+// reach of earlier items never gets past it
+static int wall_column_first(const wall_column_t *column, time_t time)
+{
+  int lo = 0;
+  int hi = column->count;
+  while (lo < hi)
+  {
+    int mid = lo + (hi - lo) / 2;
+    if (column->reach[mid] <= time)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+// First item in start order starting at or after time
+static int wall_column_end(const wall_column_t *column, time_t time)
+{
+  int lo = 0;
+  int hi = column->count;
+  while (lo < hi)
+  {
+    int mid = lo + (hi - lo) / 2;
+    if (column->schedule->items[column->order[mid]].start < time)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+//------------------------------------------------------------------------------
+// Scrolling and drawing
+//------------------------------------------------------------------------------
+
+// Part of bounds the cells scroll in, right of the time labels and below the
+// room names
+static Rectangle wall_grid(Rectangle bounds)
+{
+  float gutter = scaling_apply_x(WALL_GUTTER);
+  float header = scaling_apply_y(WALL_HEADER);
+  return (Rectangle){bounds.x + gutter, bounds.y + header, bounds.width - gutter, bounds.height - header};
+}
+
+// Height of the day, 23 or 25 hours when the clocks change
+static float wall_day_height(const wall_t *wall)
+{
+  time_t day_start = make_date_time(wall->date, 0, 0);
+  time_t day_end = make_date_time(wall->date + 1, 0, 0);
+  return (day_end - day_start) / 3600.0f * scaling_apply_y(WALL_HOUR_HEIGHT);
+}
+
+static void wall_clamp(wall_t *wall, Rectangle grid)
+{
+  float max_x = fmaxf(0, wall->count * scaling_apply_x(WALL_COLUMN_WIDTH) - grid.width);
+  float max_y = fmaxf(0, wall_day_height(wall) - grid.height);
+  wall->scroll_x = fminf(fmaxf(wall->scroll_x, 0), max_x);
+  wall->scroll_y = fminf(fmaxf(wall->scroll_y, 0), max_y);
+}
+
+void wall_scroll_to_now(wall_t *wall, Rectangle bounds, time_t now)
+{
+  // An hour of what just happened above now
+  time_t day_start = make_date_time(wall->date, 0, 0);
+  wall->scroll_y = ((now - day_start) / 3600.0f - 1) * scaling_apply_y(WALL_HOUR_HEIGHT);
+  wall_clamp(wall, wall_grid(bounds));
+}
+
+float wall_seconds_per_pixel(void)
+{
+  return 3600 / scaling_apply_y(WALL_HOUR_HEIGHT);
+}
+
+bool wall_hit(wall_t *wall, Rectangle bounds, Vector2 point, int *column, int *item)
+{
+  Rectangle grid = wall_grid(bounds);
+  if (!CheckCollisionPointRec(point, grid))
+    return false;
+
+  // Content coordinates, the same the cells are placed in before scrolling
+  float column_width = scaling_apply_x(WALL_COLUMN_WIDTH);
+  float padding = scaling_apply_x(WALL_CELL_PADDING);
+  float x = point.x - grid.x + wall->scroll_x;
+  int c = (int)(x / column_width);
+  x -= c * column_width;
+  if (c >= wall->count || x < padding || x > column_width - padding)
+    return false;
+
+  time_t day_start = make_date_time(wall->date, 0, 0);
+  time_t time = day_start + (time_t)((point.y - grid.y + wall->scroll_y) / scaling_apply_y(WALL_HOUR_HEIGHT) * 3600);
+
+  // Cells are drawn in start order, the last one covering time is on top
+  wall_column_t *room = &wall->columns[c];
+  wall_column_index(room);
+  int found = -1;
+  int end = wall_column_end(room, time + 1);
+  for (int i = wall_column_first(room, time); i < end; i++)
+  {
+    const schedule_item_t *cell = &room->schedule->items[room->order[i]];
+    if (cell->start <= time && time < cell->end)
+      found = room->order[i];
+  }
+  if (found < 0)
+    return false;
+
+  *column = c;
+  *item = found;
+  return true;
+}
+
+void wall_update(wall_t *wall, Rectangle bounds)
+{
+  Rectangle grid = wall_grid(bounds);
+  float column_width = scaling_apply_x(WALL_COLUMN_WIDTH);
+  float hour_height = scaling_apply_y(WALL_HOUR_HEIGHT);
+  Vector2 mouse = GetMousePosition();
+
+  // Wheel scrolls down the day, sideways (or with shift) across the rooms
+  if (CheckCollisionPointRec(mouse, bounds))
+  {
+    Vector2 wheel = GetMouseWheelMoveV();
+    if (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT))
+      wheel = (Vector2){wheel.y, 0};
+    wall->scroll_x -= wheel.x * scaling_apply_x(WALL_SCROLL_STEP);
+    wall->scroll_y -= wheel.y * scaling_apply_y(WALL_SCROLL_STEP);
+  }
+
+  // Dragging pans both ways, for touch screens
+  if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && CheckCollisionPointRec(mouse, grid))
+  {
+    wall->dragging = true;
+    wall->drag_last = mouse;
+  }
+  if (wall->dragging)
+  {
+    if (IsMouseButtonDown(MOUSE_BUTTON_LEFT))
+    {
+      wall->scroll_x -= mouse.x - wall->drag_last.x;
+      wall->scroll_y -= mouse.y - wall->drag_last.y;
+      wall->drag_last = mouse;
+    }
+    else
+    {
+      wall->dragging = false;
+    }
+  }
+
+  // Arrow keys step a room or an hour, page keys a screen
+  if (IsKeyPressed(KEY_RIGHT) || IsKeyPressedRepeat(KEY_RIGHT))
+    wall->scroll_x += column_width;
+  if (IsKeyPressed(KEY_LEFT) || IsKeyPressedRepeat(KEY_LEFT))
+    wall->scroll_x -= column_width;
+  if (IsKeyPressed(KEY_DOWN) || IsKeyPressedRepeat(KEY_DOWN))
+    wall->scroll_y += hour_height;
+  if (IsKeyPressed(KEY_UP) || IsKeyPressedRepeat(KEY_UP))
+    wall->scroll_y -= hour_height;
+  if (IsKeyPressed(KEY_PAGE_DOWN))
+    wall->scroll_y += grid.height;
+  if (IsKeyPressed(KEY_PAGE_UP))
+    wall->scroll_y -= grid.height;
+
+  wall_clamp(wall, grid);
+
+  if (!wall_hit(wall, bounds, mouse, &wall->hover_column, &wall->hover_item))
+    wall->hover_column = -1;
+  if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && CheckCollisionPointRec(mouse, grid))
+  {
+    wall->selected_column = wall->hover_column;
+    wall->selected_item = wall->hover_item;
+  }
+}
+
+static void wall_draw_cell(text_cache_t *text, const schedule_item_t *item, Rectangle cell, time_t now,
+                           bool hovered, bool selected)
+{
+  bool is_current = now >= item->start && now <= item->end;
+  bool is_past = now > item->end;
+
+  Color color = item->type == SCHEDULE_ITEM_TYPE_BREAK ? WALL_BREAK : WALL_EVENT;
+  Color line = is_current ? PURPLE : is_past ? WALL_LINE
+                                             : DARKGRAY;
+  DrawRectangleRec(cell, color);
+  if (hovered)
+    DrawRectangleRec(cell, (Color){0, 0, 0, 12});
+  if (selected)
+    DrawRectangleLinesEx(cell, 3, BLUE);
+  else
+    DrawRectangleLinesEx(cell, is_current ? 2 : 1, line);
+
+  // Time on top and the title wrapped below it, as much as fits. Short
+  // items are a coloured block.
+  float padding = scaling_apply_x(WALL_CELL_PADDING);
+  float title_size = scaling_apply_y(WALL_FONT_SIZE);
+  float time_size = scaling_apply_y(WALL_SMALL_FONT_SIZE);
+  float y = cell.y + padding;
+  float bottom = cell.y + cell.height - padding;
+  if (y + time_size + padding + title_size <= bottom)
+  {
+    char duration[FORMAT_DURATION_SIZE];
+    format_duration(item->start, item->end, duration, sizeof(duration));
+    DrawText(duration, cell.x + padding, y, time_size, DARKGRAY);
+    y += time_size + padding;
+  }
+
+  if (y + title_size > bottom)
+    return;
+  // Lines are spaced at one and a half times the font size, or closer
+  int lines = (int)((bottom - y - title_size) / (title_size * 1.5f)) + 1;
+  DrawText(text_cache_fit(text, item->title, title_size, cell.width - 2 * padding, lines),
+           cell.x + padding, y, title_size, BLACK);
+}
+
+void wall_draw(wall_t *wall, Rectangle bounds, time_t now)
+{
+  Rectangle grid = wall_grid(bounds);
+  float column_width = scaling_apply_x(WALL_COLUMN_WIDTH);
+  float hour_height = scaling_apply_y(WALL_HOUR_HEIGHT);
+  float header = grid.y - bounds.y;
+  float padding = scaling_apply_x(WALL_CELL_PADDING);
+  time_t day_start = make_date_time(wall->date, 0, 0);
+  float midnight = grid.y - wall->scroll_y; // Screen y of the start of the day
+
+  // What's in view on both axes, rooms by column width and the day by time
+  int first = (int)(wall->scroll_x / column_width);
+  int last = (int)ceilf((wall->scroll_x + grid.width) / column_width);
+  if (last > wall->count)
+    last = wall->count;
+  time_t from = day_start + (time_t)(wall->scroll_y / hour_height * 3600);
+  time_t to = day_start + (time_t)ceilf((wall->scroll_y + grid.height) / hour_height * 3600);
+
+  // Hour lines and their labels down the gutter
+  int first_hour = (int)(wall->scroll_y / hour_height);
+  int last_hour = (int)ceilf((wall->scroll_y + grid.height) / hour_height);
+  BeginScissorMode(bounds.x, grid.y, bounds.width, grid.height);
+  for (int hour = first_hour; hour <= last_hour; hour++)
+  {
+    float y = midnight + hour * hour_height;
+    DrawLine(grid.x, y, bounds.x + bounds.width, y, WALL_LINE);
+    DrawText(format_time(day_start + hour * 3600), bounds.x + padding, y + padding,
+             scaling_apply_y(WALL_SMALL_FONT_SIZE), DARKGRAY);
+  }
+  EndScissorMode();
+
+  for (int c = first; c < last; c++)
+  {
+    wall_column_t *column = &wall->columns[c];
+    float x = grid.x + c * column_width - wall->scroll_x;
+
+    // Each column clips its own cells and name, clipped in turn to the grid
+    float left = fmaxf(x, grid.x);
+    float right = fminf(x + column_width, grid.x + grid.width);
+    BeginScissorMode(left, bounds.y, right - left, bounds.height);
+
+    wall_column_index(column);
+    int end = wall_column_end(column, to);
+    for (int i = wall_column_first(column, from); i < end; i++)
+    {
+      const schedule_item_t *item = &column->schedule->items[column->order[i]];
+      if (item->end <= from)
+        continue; // Behind an earlier item that runs longer
+
+      Rectangle cell = {
+          x + padding,
+          midnight + (item->start - day_start) / 3600.0f * hour_height,
+          column_width - 2 * padding,
+          fmaxf(1, (item->end - item->start) / 3600.0f * hour_height)};
+      int index = column->order[i];
+      wall_draw_cell(wall->text, item, cell, now,
+                     c == wall->hover_column && index == wall->hover_item,
+                     c == wall->selected_column && index == wall->selected_item);
+    }
+
+    DrawRectangle(x, bounds.y, column_width, header, RAYWHITE);
+    DrawText(text_cache_fit(wall->text, column->name, scaling_apply_y(WALL_FONT_SIZE), column_width - 2 * padding, 1), x + padding, bounds.y + (header - scaling_apply_y(WALL_FONT_SIZE)) / 2,
+             scaling_apply_y(WALL_FONT_SIZE), BLACK);
+    DrawLine(x, bounds.y, x, bounds.y + bounds.height, WALL_LINE);
+    EndScissorMode();
+  }
+  DrawLine(bounds.x, grid.y, bounds.x + bounds.width, grid.y, (Color){GRAY.r, GRAY.g, GRAY.b, 100});
+
+  // Now, across every room
+  float now_y = midnight + (now - day_start) / 3600.0f * hour_height;
+  if (wall->date == date_today() && now_y >= grid.y && now_y <= grid.y + grid.height)
+  {
+    DrawLineEx((Vector2){grid.x, now_y}, (Vector2){grid.x + grid.width, now_y}, 2, RED);
+  }
+}
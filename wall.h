@@ -0,0 +1,79 @@
+#ifndef WALL_H
+#define WALL_H
+
+#include "raylib.h"
+#include "data.h"
+#include "calendar.h"
+#include "textcache.h"
+
+// One room on the wall, a column with a calendar of its own
+typedef struct wall_column
+{
+  char name[64];
+  calendar_t *calendar;
+  schedule_t *schedule; // Day on the wall, NULL when the room has none
+  bool pending;         // Day on the wall is still being read in the background
+  bool indexed;         // order and reach were built for this schedule
+  unsigned int version; // at this version
+  int *order;           // Items by start time
+  time_t *reach;        // Latest end among order[0..i], so overlaps still cull
+  int count;
+  int capacity;
+} wall_column_t;
+
+// Grid of rooms across, time of day down, for lobby screens. Scrolls on both
+// axes, and only the columns and the stretch of the day in view are looked at
+// when drawing: columns are a fixed width, and each column's items are found
+// by binary search over the time range on screen.
+typedef struct wall
+{
+  wall_column_t *columns;
+  int count;
+  int date;
+  float scroll_x; // Content offsets, in screen pixels
+  float scroll_y;
+  bool dragging; // Panning with the mouse held down
+  Vector2 drag_last;
+  text_cache_t *text; // Cell titles, wrapped to the column
+  int prefetch_date;  // Day being read into the rooms in the background
+  int prefetch_next;  // Next room to start reading it for
+
+  // Cells as a room and an item index in its schedule, room -1 for none
+  int hover_column; // Under the mouse, found in wall_update
+  int hover_item;
+  int selected_column; // Picked with a click
+  int selected_item;
+} wall_t;
+
+// Every subfolder of folder is a room, holding .schedule files named like
+// those of a single schedule folder. Returns NULL when there are none.
+wall_t *wall_create(const char *folder);
+void wall_destroy(wall_t *wall);
+
+// Puts date on the wall for every room. Rooms that haven't read it yet are
+// empty until wall_poll picks it up from the background.
+void wall_show_day(wall_t *wall, int date);
+// Starts reading date for every room in the background, a few rooms at a time
+// from wall_poll, so showing it later doesn't touch the disk
+void wall_prefetch_day(wall_t *wall, int date);
+// Moves finished reads into their rooms and starts the next ones, call it from
+// the main loop. Returns true while rooms are still being read.
+bool wall_poll(wall_t *wall);
+// Re-reads the rooms whose file for the day changed on disk
+void wall_reload(wall_t *wall);
+// Scrolls so now is near the top
+void wall_scroll_to_now(wall_t *wall, Rectangle bounds, time_t now);
+// How long the now line takes to move down a pixel at the current scale
+float wall_seconds_per_pixel(void);
+
+// Cell at a point on screen. The room comes from the column width and the
+// scroll, then the item from a binary search of the room's items by time, so
+// it's O(log n) in the items of one room. Returns false over empty space.
+bool wall_hit(wall_t *wall, Rectangle bounds, Vector2 point, int *column, int *item);
+
+// Handles scrolling and the mouse for the frame, then draws the part of the
+// grid inside bounds
+void wall_update(wall_t *wall, Rectangle bounds);
+void wall_draw(wall_t *wall, Rectangle bounds, time_t now);
+
+#endif // WALL_H